@@ -22,6 +22,13 @@ public class Playground : ModuleRules
 			"EnhancedInput",
 			"BlueprintGraph",
 			"Engine",
+			"AssetRegistry",
+			"UMG",
+			"AIModule",
+			"GameplayTasks",
+			"StateTreeModule",
+			"NavigationSystem",
+			"Landscape",
 			"CrabToolsUE5",});
 
 		PrivateIncludePathModuleNames.AddRange(new string[] {
@@ -2,6 +2,7 @@
 
 #include "PlaygroundCharacter.h"
 #include "Engine/LocalPlayer.h"
+#include "Engine/World.h"
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/InputComponent.h"
@@ -11,6 +12,10 @@
 #include "GameFramework/SpringArmComponent.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
+#include "EventCharMovementComponent.h"
+#include "CharacterMachineSubsystem.h"
+#include "SpellAssetSubsystem.h"
+#include "Engine/GameInstance.h"
 
 typedef PlaygroundCharacterStateMachine Machine;
 typedef PlaygroundCharacterStateMachine::PlaygroundCharacterState State;
@@ -18,16 +23,37 @@ typedef PlaygroundCharacterStateMachine::PlaygroundCharacterState State;
 // -------------------------------- State Machine ------------------------
 
 void Machine::UpdateState(PlaygroundCharacterState* To) {
+	MACHINE_SCOPE(UpdateState);
+	#if PLAYGROUND_MACHINE_STATS
+		FMachineStats::FRedirectScope Redirect(this->Stats);
+	#endif
+
 	int TID = this->TRANSITION.EnterTransition();
 	PlaygroundCharacterState* From = this->CurrentState;
 	if (From != To) {
-		From->Exit();
-		auto Check = To->Enter();
+		PlaygroundCharacterState* Check;
+		{
+			MACHINE_PHASE_SCOPE(EXIT, From->ID);
+			From->Exit();
+		}
+		{
+			MACHINE_PHASE_SCOPE(ENTER, To->ID);
+			Check = To->Enter();
+		}
 
 		if (Check == To) {
+			this->MarkPending();
 			this->CurrentState = To;
+			if (this->Actor) {
+				this->Actor->RequestMovementCheck();
+			}
+			#if PLAYGROUND_MACHINE_STATS
+				this->Stats.RecordTransition(From->ID, To->ID);
+			#endif
+
+			MACHINE_SCOPE(Listeners);
 			for (const FStateChangeListener& a : this->Listeners) {
-				a.ExecuteIfBound(From->GetState(), To->GetState());
+				a.ExecuteIfBound((EPlaygroundCharacterState) From->ID, (EPlaygroundCharacterState) To->ID);
 				if (!this->TRANSITION.Valid(TID)) {
 					break;
 				}
@@ -40,6 +66,11 @@ void Machine::UpdateState(PlaygroundCharacterState* To) {
 	}
 }
 
+State* Machine::DecideStep(float DeltaTime) {
+	MACHINE_PHASE_SCOPE(STEP, this->CurrentState->ID);
+	return this->CurrentState->Step(DeltaTime);
+}
+
 State* State::AttemptLook() {
 	if (this->GetActor()->Controller != nullptr && !GetActor()->GetPerspective()->HasTarget())
 	{
@@ -51,9 +82,41 @@ State* State::AttemptLook() {
 	return this;
 }
 
+void Machine::MarkPending() {
+	if (!this->NotificationsPending && this->BatchListeners.Num() > 0) {
+		this->NotificationsPending = true;
+		this->PendingFrom = (EPlaygroundCharacterState) this->CurrentState->ID;
+		this->PendingActions = this->CurrentActions;
+	}
+}
+
+void Machine::FlushNotifications() {
+	if (!this->NotificationsPending) {
+		return;
+	}
+	this->NotificationsPending = false;
+
+	FCharacterChangeBatch Batch;
+	Batch.From = this->PendingFrom;
+	Batch.To = (EPlaygroundCharacterState) this->CurrentState->ID;
+	Batch.AddedActions = this->CurrentActions.Difference(this->PendingActions).Flags;
+	Batch.RemovedActions = this->PendingActions.Difference(this->CurrentActions).Flags;
+
+	if (Batch.From == Batch.To && Batch.AddedActions.IsEmpty() && Batch.RemovedActions.IsEmpty()) {
+		return;
+	}
+
+	MACHINE_SCOPE(Listeners);
+	for (const FBatchChangeListener& a : this->BatchListeners) {
+		a.ExecuteIfBound(Batch);
+	}
+}
+
 void Machine::AddAction(EPlaygroundCharacterActions Action) {
 	if (!this->CurrentActions.Contains(Action)) {
+		this->MarkPending();
 		this->CurrentActions.Add(Action);
+		MACHINE_SCOPE(Listeners);
 		for (const FActionChangeListener& a : this->ActionListeners) {
 			a.ExecuteIfBound(Action, true);
 		}
@@ -63,7 +126,9 @@ void Machine::AddAction(EPlaygroundCharacterActions Action) {
 
 void Machine::RemoveAction(EPlaygroundCharacterActions Action) {
 	if (this->CurrentActions.Contains(Action)) {
+		this->MarkPending();
 		this->CurrentActions.Remove(Action);
+		MACHINE_SCOPE(Listeners);
 		for (const FActionChangeListener& a : this->ActionListeners) {
 			a.ExecuteIfBound(Action, false);
 		}
@@ -71,20 +136,32 @@ void Machine::RemoveAction(EPlaygroundCharacterActions Action) {
 }
 
 void Machine::ClearActions() {
-	for (const EPlaygroundCharacterActions& a: this->CurrentActions) {
-		this->RemoveAction(a);
+	// Snapshot first so listeners see the set already cleared, and we never iterate what we modify.
+	const TFlagSet<EPlaygroundCharacterActions> Removed = this->CurrentActions;
+	if (!Removed.IsEmpty()) {
+		this->MarkPending();
 	}
+	this->CurrentActions.Reset();
+
+	MACHINE_SCOPE(Listeners);
+
+	Removed.ForEach([this](EPlaygroundCharacterActions Action) {
+		for (const FActionChangeListener& a : this->ActionListeners) {
+			a.ExecuteIfBound(Action, false);
+		}
+	});
 }
 
 void Machine::DeflectionEvent(bool AgainstPlayer) {
 	this->CurrentState->DeflectionEvent(AgainstPlayer);
 }
 
-
 //////////////////////////////////////////////////////////////////////////
 // APlaygroundCharacter
 
-APlaygroundCharacter::APlaygroundCharacter() : Machine(this)
+APlaygroundCharacter::APlaygroundCharacter(const FObjectInitializer& ObjectInitializer) 
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UEventCharMovementComponent>(ACharacter::CharacterMovementComponentName)),
+	Machine(this)
 {
 	PrimaryActorTick.bCanEverTick = true;
 	// Set size for collision capsule
@@ -130,6 +207,18 @@ void APlaygroundCharacter::BeginPlay()
 	// Call the base class  
 	Super::BeginPlay();
 
+	// Replayed input has to land where live input does: before this actor and its movement tick.
+	this->InputTick.Target = this;
+	this->InputTick.TickGroup = TG_PrePhysics;
+	this->InputTick.bCanEverTick = true;
+	this->InputTick.bStartWithTickEnabled = false;
+	this->InputTick.RegisterTickFunction(this->GetLevel());
+	this->PrimaryActorTick.AddPrerequisite(this, this->InputTick);
+	this->GetCharacterMovement()->PrimaryComponentTick.AddPrerequisite(this, this->InputTick);
+	this->PostTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(
+		this, &APlaygroundCharacter::OnWorldPostActorTick);
+	this->SetEventDrivenMovement(this->bEventDrivenMovement);
+
 	if (APlayerController* PlayerController = Cast<APlayerController>(Controller))
 	{
 		if (UEnhancedInputLocalPlayerSubsystem* Subsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PlayerController->GetLocalPlayer()))
@@ -139,11 +228,81 @@ void APlaygroundCharacter::BeginPlay()
 	}
 }
 
+void APlaygroundCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	this->InputTick.UnRegisterTickFunction();
+	FWorldDelegates::OnWorldPostActorTick.Remove(this->PostTickHandle);
+	if (auto Subsystem = UWorld::GetSubsystem<UCharacterMachineSubsystem>(this->GetWorld())) {
+		Subsystem->Unregister(this);
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+void APlaygroundCharacter::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds) {
+	if (World == this->GetWorld()) {
+		this->RunMovementCheck();
+		this->Machine.FlushNotifications();
+	}
+}
+
+void APlaygroundCharacter::SetEventDrivenMovement(bool bEnabled) {
+	auto Movement = Cast<UEventCharMovementComponent>(this->GetCharacterMovement());
+
+	if (Movement == nullptr) {
+		// Nothing to listen to, so fall back to polling.
+		this->bEventDrivenMovement = false;
+		this->RefreshStepMode();
+		return;
+	}
+
+	this->bEventDrivenMovement = bEnabled;
+	if (bEnabled) {
+		Movement->MovementModeChangedEvent.AddUniqueDynamic(this, &APlaygroundCharacter::OnMovementModeEvent);
+	} else {
+		Movement->MovementModeChangedEvent.RemoveDynamic(this, &APlaygroundCharacter::OnMovementModeEvent);
+	}
+	this->RefreshStepMode();
+}
+
+void APlaygroundCharacter::RefreshStepMode() {
+	auto Subsystem = UWorld::GetSubsystem<UCharacterMachineSubsystem>(this->GetWorld());
+	const bool bBatched = this->bBatchStepping && !this->bEventDrivenMovement && Subsystem != nullptr;
+
+	if (Subsystem) {
+		if (bBatched) {
+			Subsystem->Register(this);
+		} else {
+			Subsystem->Unregister(this);
+		}
+	}
+
+	// Batched characters keep ticking for Blueprint Event Tick, only their machine step moves.
+	this->bSteppedExternally = this->bEventDrivenMovement || bBatched;
+	this->SetActorTickEnabled(!this->bEventDrivenMovement);
+}
+
+void APlaygroundCharacter::RequestMovementCheck() {
+	this->bMovementCheckPending = this->bEventDrivenMovement;
+}
+
+void APlaygroundCharacter::RunMovementCheck() {
+	if (this->bMovementCheckPending) {
+		this->bMovementCheckPending = false;
+		this->Machine.Step(0.0f);
+	}
+}
+
+void APlaygroundCharacter::OnMovementModeEvent(UEventCharMovementComponent* Component, EMovementMode Previous, uint8 PreviousCustom) {
+	// States only Step on falling changes, so stepping on a mode change gives the same transitions as polling.
+	this->Machine.Step(0.0f);
+}
+
 // Called every frame
 void APlaygroundCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
-	this->Machine.Step(DeltaTime);
+	if (!this->bSteppedExternally) {
+		this->Machine.Step(DeltaTime);
+	}
 }
 
 
@@ -170,7 +329,7 @@ void APlaygroundCharacter::SetupPlayerInputComponent(class UInputComponent* Play
 		
 		//Jumping
 		EnhancedInputComponent->BindAction(JumpAction, ETriggerEvent::Started, this, &APlaygroundCharacter::JumpInput);
-		EnhancedInputComponent->BindAction(JumpAction, ETriggerEvent::Completed, this, &ACharacter::StopJumping);
+		EnhancedInputComponent->BindAction(JumpAction, ETriggerEvent::Completed, this, &APlaygroundCharacter::StopJumpInput);
 
 		//Moving
 		EnhancedInputComponent->BindAction(MoveAction, ETriggerEvent::Triggered, this, &APlaygroundCharacter::Move);
@@ -198,58 +357,192 @@ void APlaygroundCharacter::SetupPlayerInputComponent(class UInputComponent* Play
 }
 
 void APlaygroundCharacter::JumpInput(const FInputActionValue& Value) {
+	if (!this->AcceptInput(EInputRecordAction::JUMP, Value)) {
+		return;
+	}
 	this->Machine.AttemptJump();
 }
 
+void APlaygroundCharacter::StopJumpInput(const FInputActionValue& Value) {
+	if (!this->AcceptInput(EInputRecordAction::STOP_JUMP, Value)) {
+		return;
+	}
+	this->StopJumping();
+}
+
 void APlaygroundCharacter::StopRunInput(const FInputActionValue& Value) {
+	if (!this->AcceptInput(EInputRecordAction::STOP_RUN, Value)) {
+		return;
+	}
 	this->Machine.RunPressed = false;
 	this->Machine.RunUpdate();
 }
 
 void APlaygroundCharacter::RunInput(const FInputActionValue& Value) {
+	if (!this->AcceptInput(EInputRecordAction::RUN, Value)) {
+		return;
+	}
 	this->Machine.RunPressed = true;
 	this->Machine.RunUpdate();
 }
 
 void APlaygroundCharacter::StopMove(const FInputActionValue& Value) {
+	if (!this->AcceptInput(EInputRecordAction::STOP_MOVE, Value)) {
+		return;
+	}
 	this->Machine.StopMove();
 	//this->UpdateState(this->CurrentState->StopMove(this));
 }
 
 void APlaygroundCharacter::SpellCastInput(const FInputActionValue& Value)
 {
+	if (!this->AcceptInput(EInputRecordAction::SPELLCAST, Value)) {
+		return;
+	}
 	this->StartCast();
 }
 
 void APlaygroundCharacter::AttackInput(const FInputActionValue& Value)
 {
+	if (!this->AcceptInput(EInputRecordAction::ATTACK, Value)) {
+		return;
+	}
 	this->StartAttack();
 }
 
 void APlaygroundCharacter::GuardInput(const FInputActionValue& Value)
 {
+	if (!this->AcceptInput(EInputRecordAction::GUARD, Value)) {
+		return;
+	}
 	this->Machine.GuardPressed = true;
 	this->StartGuard();
 }
 
 void APlaygroundCharacter::GuardRelease(const FInputActionValue& Value) {
+	if (!this->AcceptInput(EInputRecordAction::GUARD_RELEASE, Value)) {
+		return;
+	}
 	this->Machine.GuardPressed = false;
 	this->FinishGuard();
 }
 
 void APlaygroundCharacter::Move(const FInputActionValue& Value)	{	
+	if (!this->AcceptInput(EInputRecordAction::MOVE, Value)) {
+		return;
+	}
 	this->Machine.InputAxis = Value.Get<FVector2D>();
 	this->Machine.AttemptMove();
 }
 
 void APlaygroundCharacter::Look(const FInputActionValue& Value)
 {
+	if (!this->AcceptInput(EInputRecordAction::LOOK, Value)) {
+		return;
+	}
 	// input is a Vector2D
 	this->Machine.LookAxis = Value.Get<FVector2D>();
 	this->Machine.AttemptLook();
 	
 }
 
+// ------------------------------ Input Recording ------------------------------
+
+void FPlaygroundInputTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread,
+	const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (IsValid(this->Target)) {
+		this->Target->TickInput(DeltaTime);
+	}
+}
+
+FString FPlaygroundInputTickFunction::DiagnosticMessage() {
+	return FString::Printf(TEXT("%s[InputTick]"), *GetNameSafe(this->Target));
+}
+
+void APlaygroundCharacter::RefreshInputTick() {
+	if (this->InputTick.IsTickFunctionRegistered()) {
+		this->InputTick.SetTickFunctionEnable(this->Recording.IsValid() || this->Replay.IsValid());
+	}
+}
+
+void APlaygroundCharacter::TickInput(float DeltaTime) {
+	if (this->Recording.IsValid()) {
+		this->Recording->SetDelta((uint32) (GFrameCounter - this->RecordingStartFrame), DeltaTime);
+	}
+
+	if (this->Replay.IsValid()) {
+		this->StepReplay();
+	}
+}
+
+float APlaygroundCharacter::GetReplayDeltaTime(float Default) const {
+	return this->Replay.IsValid() ? this->Replay->GetDelta(this->ReplayFrame, Default) : Default;
+}
+
+void APlaygroundCharacter::StartInputRecording() {
+	this->Recording = MakeUnique<FInputRecording>();
+	this->RecordingStartFrame = GFrameCounter;
+	this->RefreshInputTick();
+}
+
+bool APlaygroundCharacter::StopInputRecording(const FString& Path) {
+	if (!this->Recording.IsValid()) {
+		return false;
+	}
+
+	const bool bSaved = this->Recording->Save(Path);
+	this->Recording.Reset();
+	this->RefreshInputTick();
+	return bSaved;
+}
+
+bool APlaygroundCharacter::StartInputReplay(const FString& Path) {
+	auto Loaded = MakeUnique<FInputRecording>();
+	if (!Loaded->Load(Path)) {
+		return false;
+	}
+
+	this->Replay = MoveTemp(Loaded);
+	this->ReplayIndex = 0;
+	this->ReplayFrame = 0;
+	this->RefreshInputTick();
+	return true;
+}
+
+void APlaygroundCharacter::StepReplay() {
+	const TArray<FInputRecord>& Records = this->Replay->Records;
+
+	while (this->ReplayIndex < Records.Num() && Records[this->ReplayIndex].Frame <= this->ReplayFrame) {
+		const FInputRecord& Record = Records[this->ReplayIndex];
+		TGuardValue<bool> Dispatching(this->bDispatchingReplay, true);
+		this->DispatchInput(Record.Action, Record.Value);
+		this->ReplayIndex += 1;
+	}
+
+	this->ReplayFrame += 1;
+	if (this->ReplayIndex >= Records.Num()) {
+		this->Replay.Reset();
+		this->RefreshInputTick();
+	}
+}
+
+void APlaygroundCharacter::DispatchInput(EInputRecordAction Action, const FInputActionValue& Value) {
+	switch (Action) {
+		case EInputRecordAction::JUMP: this->JumpInput(Value); break;
+		case EInputRecordAction::STOP_JUMP: this->StopJumpInput(Value); break;
+		case EInputRecordAction::MOVE: this->Move(Value); break;
+		case EInputRecordAction::STOP_MOVE: this->StopMove(Value); break;
+		case EInputRecordAction::RUN: this->RunInput(Value); break;
+		case EInputRecordAction::STOP_RUN: this->StopRunInput(Value); break;
+		case EInputRecordAction::LOOK: this->Look(Value); break;
+		case EInputRecordAction::SPELLCAST: this->SpellCastInput(Value); break;
+		case EInputRecordAction::ATTACK: this->AttackInput(Value); break;
+		case EInputRecordAction::GUARD: this->GuardInput(Value); break;
+		case EInputRecordAction::GUARD_RELEASE: this->GuardRelease(Value); break;
+	}
+}
+
 void APlaygroundCharacter::FinishCast() {
 	this->Machine.FinishCast(); 
 }
@@ -259,7 +552,33 @@ void APlaygroundCharacter::StartCast_Implementation() {
 	this->Machine.AttemptCast();
 }
 
+void APlaygroundCharacter::SetActiveSpell(FName Spell) {
+	if (Spell != this->ActiveSpellName) {
+		this->ActiveSpellName = Spell;
+		this->ActiveSpell = FSpellHandle();
+	}
+}
+
+FSpellHandle APlaygroundCharacter::GetActiveSpell() {
+	if (!this->ActiveSpell.IsValid() && !this->ActiveSpellName.IsNone()) {
+		// Handles index the table compiled at runtime, so they are resolved here rather than saved.
+		auto Instance = this->GetGameInstance();
+		if (auto Spells = Instance ? Instance->GetSubsystem<USpellAssetSubsystem>() : nullptr) {
+			this->ActiveSpell = Spells->FindSpellHandle(this->ActiveSpellName);
+		}
+	}
+	return this->ActiveSpell;
+}
+
 float APlaygroundCharacter::DefineCastTime_Implementation() {
+	const FSpellHandle Spell = this->GetActiveSpell();
+	if (Spell.IsValid()) {
+		auto Instance = this->GetGameInstance();
+		auto Spells = Instance ? Instance->GetSubsystem<USpellAssetSubsystem>() : nullptr;
+		if (Spells && Spells->IsValidSpellHandle(Spell)) {
+			return Spells->GetSpellCastTime(Spell);
+		}
+	}
 	return DEFAULT_CAST_TIME;
 }
 
@@ -381,8 +700,10 @@ void Machine::Walking::ApplyMovement() {
 	auto Perspective = GetActor()->GetPerspective();
 	if (Perspective->HasTarget()) {
 		Rotation = Perspective->GetPerspective();
-	} else {
+	} else if (GetActor()->Controller != nullptr) {
 		Rotation = GetActor()->Controller->GetControlRotation();
+	} else {
+		Rotation = GetActor()->GetActorRotation();
 	}
 	const FRotator YawRotation(0, Rotation.Yaw, 0);
 
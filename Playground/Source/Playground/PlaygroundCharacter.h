@@ -7,6 +7,10 @@
 #include "InputActionValue.h"
 #include "Components/PerspectiveManager.h"
 #include "PlaygroundStatics.h"
+#include "FlagSet.h"
+#include "InputRecording.h"
+#include "MachineStats.h"
+#include "CompiledSpellTable.h"
 #include "Delegates/Delegate.h"
 #include "PlaygroundCharacter.generated.h"
 
@@ -46,8 +50,33 @@ enum class EPlaygroundCharacterActions : uint8 {
 	NOSPELL            UMETA(DisplayName = "No Spell"), // Used when attempting to cast a spell, but cannot.
 };
 
+/**
+ * Net change of a character's state and actions over one frame, delivered to batch listeners.
+ */
+USTRUCT(BlueprintType)
+struct FCharacterChangeBatch
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(BlueprintReadOnly, Category = "PlaygroundCharacter")
+	EPlaygroundCharacterState From = EPlaygroundCharacterState::IDLE;
+
+	UPROPERTY(BlueprintReadOnly, Category = "PlaygroundCharacter")
+	EPlaygroundCharacterState To = EPlaygroundCharacterState::IDLE;
+
+	/** Actions present at the end of the frame that weren't present at its start. **/
+	UPROPERTY(BlueprintReadOnly, Category = "PlaygroundCharacter")
+	FFlagSet AddedActions;
+
+	/** Actions present at the start of the frame that are gone at its end. **/
+	UPROPERTY(BlueprintReadOnly, Category = "PlaygroundCharacter")
+	FFlagSet RemovedActions;
+};
+
 DECLARE_DYNAMIC_DELEGATE_TwoParams(FStateChangeListener, EPlaygroundCharacterState, From, EPlaygroundCharacterState, To);
 DECLARE_DYNAMIC_DELEGATE_TwoParams(FActionChangeListener, EPlaygroundCharacterActions, Actions, bool, AddedQ);
+DECLARE_DYNAMIC_DELEGATE_OneParam(FBatchChangeListener, const FCharacterChangeBatch&, Batch);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FAttackEventListener);
 
 
@@ -64,14 +93,18 @@ public:
 	float CastTime = DEFAULT_CAST_TIME;
 	FVector2D InputAxis;
 	FVector2D LookAxis;
-	TSet<EPlaygroundCharacterActions> CurrentActions;
+	TFlagSet<EPlaygroundCharacterActions> CurrentActions;
 	TArray<FStateChangeListener> Listeners;
 	TArray<FActionChangeListener> ActionListeners;
+	// Listeners receiving one coalesced change per frame, see FlushNotifications.
+	TArray<FBatchChangeListener> BatchListeners;
 
 	class PlaygroundCharacterState {
 	public:
 		// Reference to owner state machine.
 		PlaygroundCharacterStateMachine* Owner;
+		// Index of this state, matches GetState().
+		uint8 ID = 0;
 
 		virtual EPlaygroundCharacterState GetState() { return EPlaygroundCharacterState::IDLE; }
 		virtual PlaygroundCharacterState* Enter() { return this; }
@@ -103,6 +136,7 @@ public:
 	
 
 	class Idle: public PlaygroundCharacterState {
+	public:
 		virtual PlaygroundCharacterState* Step(float DeltaTime) override;
 		virtual PlaygroundCharacterState* AttemptMove() override;
 		virtual PlaygroundCharacterState* AttemptJump() override;
@@ -139,6 +173,7 @@ public:
 	} RUNNING;
 
 	class Airborne : public PlaygroundCharacterState {
+	public:
 		virtual PlaygroundCharacterState* Step(float DeltaTime) override;
 		virtual PlaygroundCharacterState* Enter() override;
 		virtual EPlaygroundCharacterState GetState() override { return EPlaygroundCharacterState::AIRBORNE; }
@@ -163,6 +198,7 @@ public:
 
 	class Attacking : public Walking {
 		bool CanChain = false;
+	public:
 		virtual EPlaygroundCharacterState GetState() override { return EPlaygroundCharacterState::ATTACKING; }
 		virtual PlaygroundCharacterState* Enter() override;
 		virtual PlaygroundCharacterState* RunUpdate() override;
@@ -183,6 +219,15 @@ public:
 
 	PlaygroundCharacterState* CurrentState;
 
+	/* Sends the net state/action change since the last flush to BatchListeners. */
+	void FlushNotifications();
+
+	static constexpr int STATE_COUNT = (int) EPlaygroundCharacterState::ATTACKING + 1;
+
+#if PLAYGROUND_MACHINE_STATS
+	FMachineStats Stats;
+#endif
+
 private:
 	struct Transition {
 	private:
@@ -199,6 +244,11 @@ private:
 		}
 	} TRANSITION;
 
+	// Snapshot taken at the first change after a flush, used to compute the net diff.
+	bool NotificationsPending = false;
+	EPlaygroundCharacterState PendingFrom = EPlaygroundCharacterState::IDLE;
+	TFlagSet<EPlaygroundCharacterActions> PendingActions;
+
 public:
 	PlaygroundCharacterStateMachine(APlaygroundCharacter* Parent): Actor(Parent) {
 		this->CurrentState = &IDLE;
@@ -208,25 +258,28 @@ public:
 		this->AIRBORNE.Owner = this;
 		this->CASTING.Owner = this;
 		this->ATTACKING.Owner = this;
-	}
 
-	PlaygroundCharacterStateMachine() {
-		this->CurrentState = &IDLE;
-		this->IDLE.Owner = this;
-		this->WALKING.Owner = this;
-		this->RUNNING.Owner = this;
-		this->AIRBORNE.Owner = this;
-		this->CASTING.Owner = this;
-		this->ATTACKING.Owner = this;
+		this->IDLE.ID = (uint8) EPlaygroundCharacterState::IDLE;
+		this->WALKING.ID = (uint8) EPlaygroundCharacterState::WALKING;
+		this->RUNNING.ID = (uint8) EPlaygroundCharacterState::RUNNING;
+		this->AIRBORNE.ID = (uint8) EPlaygroundCharacterState::AIRBORNE;
+		this->CASTING.ID = (uint8) EPlaygroundCharacterState::SPELLCAST;
+		this->ATTACKING.ID = (uint8) EPlaygroundCharacterState::ATTACKING;
 	}
 
+	PlaygroundCharacterStateMachine(): PlaygroundCharacterStateMachine(nullptr) {}
+
 	void BeginPlay() {
 		for (const FStateChangeListener& a : this->Listeners) {
 			a.ExecuteIfBound(IDLE.GetState(), IDLE.GetState());
 		}
 	}
 
-	void Step(float DeltaTime) { this->UpdateState(this->CurrentState->Step(DeltaTime)); }
+	void Step(float DeltaTime) { this->UpdateState(this->DecideStep(DeltaTime)); }
+	/* Decision half of Step. State Step implementations only read, so this may run off the game thread. */
+	PlaygroundCharacterState* DecideStep(float DeltaTime);
+	/* Applies a DecideStep result, running Enter/Exit and listeners. Game thread only. */
+	void ApplyStep(PlaygroundCharacterState* To) { this->UpdateState(To); }
 	void AttemptMove() { this->UpdateState(this->CurrentState->AttemptMove()); }
 	void StopMove() { this->UpdateState(this->CurrentState->StopMove()); }
 	void RunUpdate() { this->UpdateState(this->CurrentState->RunUpdate()); }
@@ -254,6 +307,7 @@ public:
 
 private:
 	void UpdateState(PlaygroundCharacterState* To);
+	void MarkPending();
 	void AddAction(EPlaygroundCharacterActions Action);
 	void RemoveAction(EPlaygroundCharacterActions Action);
 	void ClearActions();
@@ -261,6 +315,28 @@ private:
 
 
 
+/**
+ * Pre-physics tick of a character's input recording and replay. Ticks before the character's own tick
+ * and movement, like input arriving from the player controller, and only while recording or replaying.
+ */
+USTRUCT()
+struct FPlaygroundInputTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	class APlaygroundCharacter* Target = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread,
+		const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FPlaygroundInputTickFunction> : public TStructOpsTypeTraitsBase2<FPlaygroundInputTickFunction>
+{
+	enum { WithCopy = false };
+};
+
 UCLASS(config=Game)
 class APlaygroundCharacter : public ACharacter
 {
@@ -281,6 +357,22 @@ private:
 		meta = (AllowPrivateAccess = "true"))
 	float RunningSpeed = DEFAULT_RUN_SPEED;
 
+	/**
+	 * Drive Airborne transitions from the movement component's mode change events instead of polling
+	 * every frame, and disable actor ticking. Requires a UEventCharMovementComponent.
+	 **/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "PlaygroundCharacter",
+		meta = (AllowPrivateAccess = "true"))
+	bool bEventDrivenMovement = false;
+
+	/**
+	 * Step the state machine from the world's UCharacterMachineSubsystem together with other characters
+	 * instead of from this actor's Tick. Ignored when bEventDrivenMovement is set.
+	 **/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "PlaygroundCharacter",
+		meta = (AllowPrivateAccess = "true"))
+	bool bBatchStepping = false;
+
 	UPROPERTY(BlueprintAssignable, Category = "PlaygroundCharacter", meta = (AllowPrivateAccess = "true"))
 	FAttackEventListener AttackEvent;
 
@@ -329,7 +421,7 @@ private:
 	class UInputAction* GuardAction;
 
 public:
-	APlaygroundCharacter();
+	APlaygroundCharacter(const FObjectInitializer& ObjectInitializer);
 	
 
 protected:
@@ -354,6 +446,9 @@ protected:
 	/** Called for looking input */
 	virtual void JumpInput(const FInputActionValue& Value);
 
+	/** Called for jump release */
+	virtual void StopJumpInput(const FInputActionValue& Value);
+
 	/** Called for spell cast input */
 	virtual void SpellCastInput(const FInputActionValue& Value);
 
@@ -373,8 +468,67 @@ protected:
 	
 	// To add mapping context
 	virtual void BeginPlay();
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	FDelegateHandle PostTickHandle;
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	/* Picks between event driven, batched and ticked stepping based on the current flags. */
+	void RefreshStepMode();
+	/* Set when the machine is stepped by movement mode events or UCharacterMachineSubsystem instead of Tick. */
+	bool bSteppedExternally = false;
+
+	/**
+	 * Event driven characters only step on movement mode changes, which never fire when a transition
+	 * happens while the mode holds still: entering Idle mid-air, or a Jump that never leaves the ground.
+	 * Any transition therefore schedules one Step after actors tick to catch those.
+	 */
+	bool bMovementCheckPending = false;
+
+	UFUNCTION()
+	void OnMovementModeEvent(class UEventCharMovementComponent* Component, EMovementMode Previous, uint8 PreviousCustom);
+
+	/* ActiveSpellName resolved by GetActiveSpell, cleared when the name changes. */
+	UPROPERTY(Transient)
+	FSpellHandle ActiveSpell;
+
+	/* Input recording, see StartInputRecording. */
+	TUniquePtr<FInputRecording> Recording;
+	uint64 RecordingStartFrame = 0;
+
+	/* Input replay, see StartInputReplay. */
+	TUniquePtr<FInputRecording> Replay;
+	int32 ReplayIndex = 0;
+	uint32 ReplayFrame = 0;
+	/* Set while StepReplay dispatches, so the handlers can tell replayed input from live input. */
+	bool bDispatchingReplay = false;
+
+	/* Records the input and returns true, or returns false for live input arriving during a replay. */
+	FORCEINLINE bool AcceptInput(EInputRecordAction Action, const FInputActionValue& Value) {
+		if (this->Replay.IsValid() && !this->bDispatchingReplay) {
+			return false;
+		}
+		if (this->Recording.IsValid()) {
+			this->Recording->Add((uint32) (GFrameCounter - this->RecordingStartFrame), Action, Value);
+		}
+		return true;
+	}
+
+	FPlaygroundInputTickFunction InputTick;
+	/* Enables InputTick while recording or replaying. */
+	void RefreshInputTick();
+
+	/* Feeds the replay records due this frame into the input handlers. */
+	void StepReplay();
 
 public:
+	/* Records this frame's delta time and feeds due replay records, see FPlaygroundInputTickFunction. */
+	void TickInput(float DeltaTime);
+
+	/** Recorded delta time of the frame the replay is about to play, or Default without one. **/
+	float GetReplayDeltaTime(float Default) const;
+
 	/** Returns CameraBoom subobject **/
 	FORCEINLINE class USpringArmComponent* GetCameraBoom() const { return CameraBoom; }
 	/** Returns FollowCamera subobject **/
@@ -390,9 +544,54 @@ public:
 		this->Machine.ActionListeners.Add(Del);
 	}	
 
+	/**
+	 * Registers a listener that receives the net change of state and actions once per frame, after actors
+	 * have ticked. Changes that cancel out within the frame are not reported. Use StateListen/ActionListen
+	 * for immediate per-event delivery.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "PlaygroundCharacter")
+	virtual void BatchListen(const FBatchChangeListener& Del) {
+		this->Machine.BatchListeners.Add(Del);
+	}
+
+	/** Switches between event driven and tick polled Airborne transitions, see bEventDrivenMovement. **/
+	UFUNCTION(BlueprintCallable, Category = "PlaygroundCharacter")
+	void SetEventDrivenMovement(bool bEnabled);
+
+	/* Schedules the end of frame Step of event driven characters, see bMovementCheckPending. */
+	void RequestMovementCheck();
+	/* Runs the scheduled Step, if any. Called after actors tick. */
+	void RunMovementCheck();
+
+	/** Starts recording every input handler call with its frame offset. **/
+	UFUNCTION(BlueprintCallable, Category = "PlaygroundCharacter|Input")
+	void StartInputRecording();
+
+	/** Stops recording and writes the recorded input to Path. **/
+	UFUNCTION(BlueprintCallable, Category = "PlaygroundCharacter|Input")
+	bool StopInputRecording(const FString& Path);
+
+	/**
+	 * Replays a recording made by StartInputRecording into the same input handlers, one recorded frame per
+	 * world frame. Records are injected from the pre-physics InputTick, before the character and its
+	 * movement tick, where live input would arrive. Live input is ignored until the replay ends.
+	 **/
+	UFUNCTION(BlueprintCallable, Category = "PlaygroundCharacter|Input")
+	bool StartInputReplay(const FString& Path);
+
+	UFUNCTION(BlueprintPure, Category = "PlaygroundCharacter|Input")
+	bool IsReplayingInput() const { return this->Replay.IsValid(); }
+
+	/** Calls the input handler for Action as if the input system had triggered it. **/
+	void DispatchInput(EInputRecordAction Action, const FInputActionValue& Value);
+
 	UFUNCTION(BlueprintCallable, Category = "PlaygroundCharacter")
 	void ForceState(EPlaygroundCharacterState e) { this->Machine.ForceState(e); }
 
+	/** Actions currently being performed, indexed by EPlaygroundCharacterActions. **/
+	UFUNCTION(BlueprintPure, Category = "PlaygroundCharacter")
+	FFlagSet GetCurrentActions() const { return this->Machine.CurrentActions.Flags; }
+
 
 	// ----------------------Functions for Spell Casting  -----------------------------
 	UFUNCTION(BlueprintNativeEvent, Category = "PlaygroundCharacter")
@@ -404,6 +603,17 @@ public:
 	UFUNCTION(BlueprintPure, Category = "PlaygroundCharacter")
 	float GetCastTime() { return this->DefineCastTime(); }
 
+	/** Row of the spell table used by the casting path. **/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "PlaygroundCharacter")
+	FName ActiveSpellName;
+
+	UFUNCTION(BlueprintCallable, Category = "PlaygroundCharacter")
+	void SetActiveSpell(FName Spell);
+
+	/** ActiveSpellName resolved into the compiled spell table, invalid until the table has loaded. **/
+	UFUNCTION(BlueprintPure, Category = "PlaygroundCharacter")
+	FSpellHandle GetActiveSpell();
+
 	UFUNCTION(BlueprintNativeEvent, Category = "PlaygroundCharacter")
 	float DefineCastTime();
 	virtual float DefineCastTime_Implementation();
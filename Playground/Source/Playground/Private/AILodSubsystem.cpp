@@ -0,0 +1,316 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AILodSubsystem.h"
+#include "AIController.h"
+#include "BrainComponent.h"
+#include "EngineUtils.h"
+#include "Perception/AIPerceptionComponent.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "GameFramework/PawnMovementComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_STATS_GROUP(TEXT("AILod"), STATGROUP_AILod, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Update"), STAT_AILodUpdate, STATGROUP_AILod);
+DECLARE_DWORD_COUNTER_STAT(TEXT("High"), STAT_AILodHigh, STATGROUP_AILod);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Medium"), STAT_AILodMedium, STATGROUP_AILod);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Low"), STAT_AILodLow, STATGROUP_AILod);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Dormant"), STAT_AILodDormant, STATGROUP_AILod);
+
+static const FString AI_LOD_PAUSE_REASON = TEXT("AILod");
+
+UAILodSubsystem::UAILodSubsystem() {
+	this->Buckets = {
+		{ 2500.0f,  0.0f, 0.0f,  true },
+		{ 6000.0f,  0.1f, 0.05f, true },
+		{ 12000.0f, 0.5f, 0.2f,  true },
+		{ MAX_flt,  2.0f, 1.0f,  false },
+	};
+}
+
+void UAILodSubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+	Super::Initialize(Collection);
+
+	// Config may list fewer buckets; the last one always takes everything beyond.
+	this->Buckets.SetNum((int32) EAILodBucket::COUNT);
+	this->Buckets.Last().MaxDistance = MAX_flt;
+}
+
+void UAILodSubsystem::OnWorldBeginPlay(UWorld& InWorld) {
+	Super::OnWorldBeginPlay(InWorld);
+
+	for (TActorIterator<AAIController> It(&InWorld); It; ++It) {
+		this->Register(*It);
+	}
+
+	this->SpawnHandle = InWorld.AddOnActorSpawnedHandler(
+		FOnActorSpawned::FDelegate::CreateUObject(this, &UAILodSubsystem::OnActorSpawned));
+}
+
+void UAILodSubsystem::Deinitialize() {
+	if (UWorld* World = this->GetWorld()) {
+		World->RemoveOnActorSpawnedHandler(this->SpawnHandle);
+	}
+
+	for (FAgent& Agent : this->Agents) {
+		this->ResumeBrain(Agent);
+	}
+	this->Agents.Reset();
+	Super::Deinitialize();
+}
+
+void UAILodSubsystem::OnActorSpawned(AActor* Actor) {
+	if (auto Controller = Cast<AAIController>(Actor)) {
+		this->Register(Controller);
+	}
+}
+
+void UAILodSubsystem::Register(AAIController* Controller) {
+	if (Controller == nullptr || this->Agents.ContainsByPredicate([Controller](const FAgent& Agent) { return Agent.Controller == Controller; })) {
+		return;
+	}
+
+	// Start at full rate; the first update demotes if needed without waiting out the dwell time.
+	this->Agents.Add({ Controller, EAILodBucket::HIGH, this->MinDwellTime, false, false, false, 0.0f, -1.0f });
+}
+
+void UAILodSubsystem::Unregister(AAIController* Controller) {
+	this->Agents.RemoveAllSwap([this, Controller](FAgent& Agent) {
+		if (Agent.Controller == Controller) {
+			this->ResumeBrain(Agent);
+			return true;
+		}
+		return false;
+	});
+}
+
+void UAILodSubsystem::ResumeBrain(FAgent& Agent) {
+	AAIController* Controller = Agent.Controller.Get();
+	UBrainComponent* Brain = Controller ? Controller->GetBrainComponent() : nullptr;
+
+	if (Agent.bBrainPaused && Brain != nullptr) {
+		Brain->ResumeLogic(AI_LOD_PAUSE_REASON);
+	}
+	Agent.bBrainPaused = false;
+}
+
+void UAILodSubsystem::SetInCombat(AAIController* Controller, bool bInCombat) {
+	for (FAgent& Agent : this->Agents) {
+		if (Agent.Controller == Controller) {
+			Agent.bInCombat = bInCombat;
+			return;
+		}
+	}
+}
+
+EAILodBucket UAILodSubsystem::GetBucket(AAIController* Controller) const {
+	for (const FAgent& Agent : this->Agents) {
+		if (Agent.Controller == Controller) {
+			return Agent.Bucket;
+		}
+	}
+	return EAILodBucket::HIGH;
+}
+
+FAILodBucketStats UAILodSubsystem::GetBucketStats(EAILodBucket Bucket) const {
+	return Bucket < EAILodBucket::COUNT ? this->Stats[(int32) Bucket] : FAILodBucketStats();
+}
+
+EAILodBucket UAILodSubsystem::BucketForDistance(float Distance) const {
+	for (int32 i = 0; i < (int32) EAILodBucket::COUNT - 1; ++i) {
+		if (Distance <= this->Buckets[i].MaxDistance) {
+			return (EAILodBucket) i;
+		}
+	}
+	return EAILodBucket::DORMANT;
+}
+
+EAILodBucket UAILodSubsystem::Classify(const FAgent& Agent, const FVector& Viewer) const {
+	const AAIController* Controller = Agent.Controller.Get();
+	const APawn* Pawn = Controller->GetPawn();
+
+	if (Pawn == nullptr) {
+		return EAILodBucket::DORMANT;
+	}
+
+	if (Agent.bInCombat || Controller->GetFocusActor() != nullptr) {
+		return EAILodBucket::HIGH;
+	}
+
+	const float Distance = FVector::Dist(Pawn->GetActorLocation(), Viewer);
+	EAILodBucket Target = this->BucketForDistance(Distance);
+
+	// Only leave the current bucket once the distance clears the boundary by the hysteresis margin.
+	if (Target > Agent.Bucket) {
+		Target = FMath::Max(Agent.Bucket, this->BucketForDistance(Distance / (1.0f + this->Hysteresis)));
+	} else if (Target < Agent.Bucket) {
+		Target = FMath::Min(Agent.Bucket, this->BucketForDistance(Distance * (1.0f + this->Hysteresis)));
+	}
+
+	// Out of view NPCs drop one bucket, but never go dormant just for being unseen.
+	if (Target < EAILodBucket::LOW && !Pawn->WasRecentlyRendered(0.5f)) {
+		Target = (EAILodBucket) ((uint8) Target + 1);
+	}
+
+	if (Target != Agent.Bucket && Agent.BucketTime < this->MinDwellTime) {
+		return Agent.Bucket;
+	}
+
+	return Target;
+}
+
+void UAILodSubsystem::Apply(FAgent& Agent, EAILodBucket Bucket) {
+	AAIController* Controller = Agent.Controller.Get();
+	const FAILodBucketSettings& Settings = this->Buckets[(int32) Bucket];
+
+	// Behavior trees reset their own tick interval whenever they schedule work, so a tick interval set
+	// here wouldn't hold. Throttled brains are paused instead and ticked from TickBrains.
+	if (Settings.BrainInterval <= 0.0f) {
+		this->ResumeBrain(Agent);
+	} else if (!Agent.bBrainPaused) {
+		UBrainComponent* Brain = Controller->GetBrainComponent();
+		// Brains paused by gameplay are left alone.
+		if (Brain != nullptr && !Brain->IsPaused()) {
+			Brain->PauseLogic(AI_LOD_PAUSE_REASON);
+			Agent.bBrainPaused = true;
+			Agent.BrainTime = 0.0f;
+		}
+	}
+
+	if (UPathFollowingComponent* PathFollowing = Controller->GetPathFollowingComponent()) {
+		PathFollowing->SetComponentTickInterval(Settings.MovementInterval);
+	}
+
+	if (APawn* Pawn = Controller->GetPawn()) {
+		if (UPawnMovementComponent* Movement = Pawn->GetMovementComponent()) {
+			Movement->SetComponentTickInterval(Settings.MovementInterval);
+		}
+	}
+
+	if (UAIPerceptionComponent* Perception = Controller->GetPerceptionComponent()) {
+		for (auto It = Perception->GetSensesConfigIterator(); It; ++It) {
+			if (*It) {
+				Perception->SetSenseEnabled((*It)->GetSenseImplementation(), Settings.bPerception);
+			}
+		}
+	}
+}
+
+void UAILodSubsystem::Update(float DeltaTime) {
+	SCOPE_CYCLE_COUNTER(STAT_AILodUpdate);
+
+	FVector Viewer = FVector::ZeroVector;
+	if (auto Camera = UGameplayStatics::GetPlayerCameraManager(this->GetWorld(), 0)) {
+		Viewer = Camera->GetCameraLocation();
+	} else if (auto Player = UGameplayStatics::GetPlayerPawn(this->GetWorld(), 0)) {
+		Viewer = Player->GetActorLocation();
+	} else {
+		return;
+	}
+
+	double Time[(int32) EAILodBucket::COUNT] = { 0 };
+	int32 Counts[(int32) EAILodBucket::COUNT] = { 0 };
+
+	this->Agents.RemoveAllSwap([](const FAgent& Agent) { return !Agent.Controller.IsValid(); });
+
+	for (FAgent& Agent : this->Agents) {
+		const double Start = FPlatformTime::Seconds();
+
+		Agent.BucketTime += DeltaTime;
+		const EAILodBucket Bucket = this->Classify(Agent, Viewer);
+
+		if (Bucket != Agent.Bucket || !Agent.bApplied) {
+			Agent.Bucket = Bucket;
+			Agent.BucketTime = 0.0f;
+			Agent.bApplied = true;
+			this->Apply(Agent, Bucket);
+		}
+
+		++Counts[(int32) Agent.Bucket];
+		Time[(int32) Agent.Bucket] += FPlatformTime::Seconds() - Start;
+	}
+
+	for (int32 i = 0; i < (int32) EAILodBucket::COUNT; ++i) {
+		this->Stats[i].Count = Counts[i];
+		this->Stats[i].EvaluationsPerSecond = DeltaTime > 0.0f ? this->BrainTicks[i] / DeltaTime : 0.0f;
+		this->Stats[i].BrainMillisecondsPerSecond = DeltaTime > 0.0f ? this->BrainSeconds[i] * 1000.0 / DeltaTime : 0.0f;
+		this->Stats[i].UpdateMilliseconds = Time[i] * 1000.0;
+		this->BrainTicks[i] = 0;
+		this->BrainSeconds[i] = 0.0;
+	}
+
+	SET_DWORD_STAT(STAT_AILodHigh, Counts[(int32) EAILodBucket::HIGH]);
+	SET_DWORD_STAT(STAT_AILodMedium, Counts[(int32) EAILodBucket::MEDIUM]);
+	SET_DWORD_STAT(STAT_AILodLow, Counts[(int32) EAILodBucket::LOW]);
+	SET_DWORD_STAT(STAT_AILodDormant, Counts[(int32) EAILodBucket::DORMANT]);
+}
+
+void UAILodSubsystem::TickBrains(float DeltaTime) {
+	for (FAgent& Agent : this->Agents) {
+		AAIController* Controller = Agent.Controller.Get();
+		UBrainComponent* Brain = Controller ? Controller->GetBrainComponent() : nullptr;
+		if (Brain == nullptr) {
+			continue;
+		}
+
+		if (!Agent.bBrainPaused) {
+			const float LastTick = Brain->PrimaryComponentTick.GetLastTickGameTime();
+			if (LastTick != Agent.LastBrainTick) {
+				Agent.LastBrainTick = LastTick;
+				++this->BrainTicks[(int32) Agent.Bucket];
+			}
+			continue;
+		}
+
+		Agent.BrainTime += DeltaTime;
+		if (Agent.BrainTime < this->Buckets[(int32) Agent.Bucket].BrainInterval) {
+			continue;
+		}
+
+		// Ticked with the whole elapsed time so waits and cooldowns in the tree keep real time. Observer
+		// notifications queued while paused are delivered by the resume.
+		const double Start = FPlatformTime::Seconds();
+		Brain->ResumeLogic(AI_LOD_PAUSE_REASON);
+		Brain->TickComponent(Agent.BrainTime, LEVELTICK_All, &Brain->PrimaryComponentTick);
+		Brain->PauseLogic(AI_LOD_PAUSE_REASON);
+		this->BrainSeconds[(int32) Agent.Bucket] += FPlatformTime::Seconds() - Start;
+
+		Agent.BrainTime = 0.0f;
+		++this->BrainTicks[(int32) Agent.Bucket];
+	}
+}
+
+void UAILodSubsystem::Tick(float DeltaTime) {
+	this->TickBrains(DeltaTime);
+	this->UpdateTimer += DeltaTime;
+
+	if (this->UpdateTimer >= this->UpdateInterval) {
+		this->Update(this->UpdateTimer);
+		this->UpdateTimer = 0.0f;
+	}
+}
+
+TStatId UAILodSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UAILodSubsystem, STATGROUP_Tickables);
+}
+
+void UAILodSubsystem::LogStats() const {
+	for (int32 i = 0; i < (int32) EAILodBucket::COUNT; ++i) {
+		UE_LOG(LogTemp, Log, TEXT("%s: %d agents, %.1f brain ticks/s, %.3f ms/s throttled brains, %.3f ms update"),
+			*UEnum::GetDisplayValueAsText((EAILodBucket) i).ToString(),
+			this->Stats[i].Count,
+			this->Stats[i].EvaluationsPerSecond,
+			this->Stats[i].BrainMillisecondsPerSecond,
+			this->Stats[i].UpdateMilliseconds);
+	}
+}
+
+static FAutoConsoleCommandWithWorld GDumpAILodCommand(
+	TEXT("Playground.DumpAILod"),
+	TEXT("Logs the number of AI controllers, measured brain ticks, throttled brain time and update time per AI LOD bucket."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World) {
+		if (auto Subsystem = UWorld::GetSubsystem<UAILodSubsystem>(World)) {
+			Subsystem->LogStats();
+		}
+	}));
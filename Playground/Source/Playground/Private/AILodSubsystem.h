@@ -0,0 +1,162 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AILodSubsystem.generated.h"
+
+class AAIController;
+
+UENUM(BlueprintType)
+enum class EAILodBucket : uint8 {
+	HIGH               UMETA(DisplayName = "High"),
+	MEDIUM             UMETA(DisplayName = "Medium"),
+	LOW                UMETA(DisplayName = "Low"),
+	DORMANT            UMETA(DisplayName = "Dormant"),
+	COUNT              UMETA(Hidden),
+};
+
+USTRUCT(BlueprintType)
+struct FAILodBucketSettings
+{
+	GENERATED_BODY()
+
+public:
+	/** NPCs further than this from the player fall into the next bucket. **/
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "AI LOD")
+	float MaxDistance = 0.0f;
+
+	/**
+	 * Seconds between brain (behavior tree or StateTree) ticks, 0 to let the brain schedule itself.
+	 * Throttled brains are kept paused and ticked by UAILodSubsystem with the elapsed time.
+	 **/
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "AI LOD")
+	float BrainInterval = 0.0f;
+
+	/** Tick interval of path following and pawn movement, 0 for every frame. **/
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "AI LOD")
+	float MovementInterval = 0.0f;
+
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "AI LOD")
+	bool bPerception = true;
+};
+
+USTRUCT(BlueprintType)
+struct FAILodBucketStats
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(BlueprintReadOnly, Category = "AI LOD")
+	int32 Count = 0;
+
+	/** Brain ticks per second of the bucket, measured over the last update. **/
+	UPROPERTY(BlueprintReadOnly, Category = "AI LOD")
+	float EvaluationsPerSecond = 0.0f;
+
+	/**
+	 * Milliseconds per second spent ticking the bucket's throttled brains, measured over the last update.
+	 * Unthrottled brains (BrainInterval 0, HIGH by default) tick on their own schedule and aren't timed
+	 * here, their cost shows under the engine's component tick stats.
+	 **/
+	UPROPERTY(BlueprintReadOnly, Category = "AI LOD")
+	float BrainMillisecondsPerSecond = 0.0f;
+
+	/** Time spent by this subsystem classifying and applying settings to the bucket, last update. **/
+	UPROPERTY(BlueprintReadOnly, Category = "AI LOD")
+	float UpdateMilliseconds = 0.0f;
+};
+
+/**
+ * Sorts AI controllers into significance buckets from their pawn's distance to the player, whether it
+ * was recently rendered and whether it is in combat, then throttles brain ticks, perception and
+ * movement per bucket. Moving between buckets needs the distance to clear the boundary by Hysteresis
+ * and the NPC to have stayed in its bucket for MinDwellTime, so NPCs at a boundary don't flicker.
+ *
+ * AI controllers are registered automatically when spawned.
+ */
+UCLASS(Config=Game)
+class UAILodSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	struct FAgent {
+		TWeakObjectPtr<AAIController> Controller;
+		EAILodBucket Bucket;
+		float BucketTime;
+		bool bInCombat;
+		// False until the bucket's settings were first applied.
+		bool bApplied;
+		// Set while this subsystem keeps the brain paused to throttle it.
+		bool bBrainPaused;
+		// Time since the throttled brain last ticked.
+		float BrainTime;
+		// Last engine tick of an unthrottled brain, to count its ticks.
+		float LastBrainTick;
+	};
+
+	TArray<FAgent> Agents;
+	FAILodBucketStats Stats[(int32) EAILodBucket::COUNT];
+	// Brain ticks per bucket since the last update.
+	int32 BrainTicks[(int32) EAILodBucket::COUNT] = { 0 };
+	// Seconds spent ticking throttled brains per bucket since the last update.
+	double BrainSeconds[(int32) EAILodBucket::COUNT] = { 0 };
+	FDelegateHandle SpawnHandle;
+	float UpdateTimer = 0.0f;
+
+public:
+	/** Settings per bucket, from HIGH to DORMANT. **/
+	UPROPERTY(Config, EditAnywhere, Category = "AI LOD")
+	TArray<FAILodBucketSettings> Buckets;
+
+	/** Seconds between reclassifications. **/
+	UPROPERTY(Config, EditAnywhere, Category = "AI LOD")
+	float UpdateInterval = 0.25f;
+
+	/** Fraction of a bucket boundary the distance has to clear before an NPC changes bucket. **/
+	UPROPERTY(Config, EditAnywhere, Category = "AI LOD")
+	float Hysteresis = 0.1f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "AI LOD")
+	float MinDwellTime = 1.0f;
+
+	UAILodSubsystem();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	UFUNCTION(BlueprintCallable, Category = "AI LOD")
+	void Register(AAIController* Controller);
+
+	UFUNCTION(BlueprintCallable, Category = "AI LOD")
+	void Unregister(AAIController* Controller);
+
+	/** Keeps a controller in the HIGH bucket while set, on top of having a focus actor. **/
+	UFUNCTION(BlueprintCallable, Category = "AI LOD")
+	void SetInCombat(AAIController* Controller, bool bInCombat);
+
+	UFUNCTION(BlueprintPure, Category = "AI LOD")
+	EAILodBucket GetBucket(AAIController* Controller) const;
+
+	UFUNCTION(BlueprintPure, Category = "AI LOD")
+	FAILodBucketStats GetBucketStats(EAILodBucket Bucket) const;
+
+	/** Reclassifies every agent now. **/
+	void Update(float DeltaTime);
+
+	void LogStats() const;
+
+private:
+	EAILodBucket Classify(const FAgent& Agent, const FVector& Viewer) const;
+	EAILodBucket BucketForDistance(float Distance) const;
+	void Apply(FAgent& Agent, EAILodBucket Bucket);
+	/* Ticks throttled brains that are due and counts the ticks of the others. */
+	void TickBrains(float DeltaTime);
+	/* Hands a throttled brain back to its own scheduling. */
+	void ResumeBrain(FAgent& Agent);
+	void OnActorSpawned(AActor* Actor);
+};
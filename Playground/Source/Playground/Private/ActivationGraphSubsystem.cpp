@@ -0,0 +1,491 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ActivationGraphSubsystem.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "PlaygroundStatics.h"
+#include "UObject/UnrealType.h"
+
+DECLARE_STATS_GROUP(TEXT("ActivationGraph"), STATGROUP_ActivationGraph, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Build"), STAT_ActivationGraphBuild, STATGROUP_ActivationGraph);
+DECLARE_CYCLE_STAT(TEXT("Propagate"), STAT_ActivationGraphPropagate, STATGROUP_ActivationGraph);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Nodes"), STAT_ActivationGraphNodes, STATGROUP_ActivationGraph);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Edges"), STAT_ActivationGraphEdges, STATGROUP_ActivationGraph);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Visited"), STAT_ActivationGraphVisited, STATGROUP_ActivationGraph);
+
+/** The dispatcher named Name on Actor, if it takes a single bool. **/
+static FMulticastDelegateProperty* FindDispatcher(AActor* Actor, FName Name) {
+	auto Dispatcher = FindFProperty<FMulticastDelegateProperty>(Actor->GetClass(), Name);
+	if (Dispatcher == nullptr || Dispatcher->SignatureFunction == nullptr) {
+		return nullptr;
+	}
+
+	const UFunction* Signature = Dispatcher->SignatureFunction;
+	if (Signature->NumParms != 1 || CastField<FBoolProperty>(Signature->PropertyLink) == nullptr) {
+		return nullptr;
+	}
+
+	return Dispatcher;
+}
+
+void UActivationSignalProxy::OnActivation(bool ActivatedQ) {
+	if (auto Graph = UWorld::GetSubsystem<UActivationGraphSubsystem>(this->GetWorld())) {
+		Graph->SetSignal(this->Source.Get(), ActivatedQ);
+	}
+}
+
+void UActivationGraphSubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+	Super::Initialize(Collection);
+
+	this->LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UActivationGraphSubsystem::OnLevelsChanged);
+	this->LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UActivationGraphSubsystem::OnLevelsChanged);
+}
+
+void UActivationGraphSubsystem::Deinitialize() {
+	FWorldDelegates::LevelAddedToWorld.Remove(this->LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(this->LevelRemovedHandle);
+
+	this->Nodes.Reset();
+	this->Inputs.Reset();
+	this->Index.Reset();
+	this->Proxies.Reset();
+	this->Classes.Reset();
+	Super::Deinitialize();
+}
+
+void UActivationGraphSubsystem::OnWorldBeginPlay(UWorld& InWorld) {
+	Super::OnWorldBeginPlay(InWorld);
+	this->Build();
+}
+
+void UActivationGraphSubsystem::OnLevelsChanged(ULevel* Level, UWorld* InWorld) {
+	if (InWorld != this->GetWorld() || this->bRebuild) {
+		return;
+	}
+
+	// World Partition streams many cells without activators, only the ones holding nodes change the graph.
+	// It is rebuilt once on the next tick however many stream at once.
+	if (Level == nullptr) {
+		this->bRebuild = true;
+		return;
+	}
+
+	for (const AActor* Actor : Level->Actors) {
+		if (this->IsNode(Actor)) {
+			this->bRebuild = true;
+			return;
+		}
+	}
+
+	// A removed level may already have let go of its actors, the nodes still know where they came from.
+	for (const FNode& Node : this->Nodes) {
+		const AActor* Actor = Node.Actor.Get();
+		if (Actor == nullptr || Actor->GetLevel() == Level) {
+			this->bRebuild = true;
+			return;
+		}
+	}
+}
+
+bool UActivationGraphSubsystem::IsActivator(const AActor* Actor) const {
+	if (Actor == nullptr) {
+		return false;
+	}
+
+	const UClass* Class = Actor->GetClass();
+	for (const UClass* Activator : this->Classes) {
+		if (Activator->HasAnyClassFlags(CLASS_Interface) ? Class->ImplementsInterface(Activator) : Class->IsChildOf(Activator)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool UActivationGraphSubsystem::IsNode(const AActor* Actor) const {
+	return this->IsActivator(Actor) || (Actor && Actor->FindComponentByClass<UActivationNodeComponent>());
+}
+
+void UActivationGraphSubsystem::CollectSources(AActor* Actor, TArray<AActor*>& OutSources) const {
+	auto Add = [&](UObject* Object) {
+		AActor* Source = Cast<AActor>(Object);
+		if (Source && Source != Actor && this->IsActivator(Source)) {
+			OutSources.AddUnique(Source);
+		}
+	};
+
+	// Only the named variables list sources, others may reference the activators this one drives.
+	for (FName Name : this->SourceProperties) {
+		FProperty* Property = FindFProperty<FProperty>(Actor->GetClass(), Name);
+		if (Property == nullptr) {
+			continue;
+		}
+
+		if (auto Object = CastField<FObjectPropertyBase>(Property)) {
+			for (int32 i = 0; i < Object->ArrayDim; ++i) {
+				Add(Object->GetObjectPropertyValue_InContainer(Actor, i));
+			}
+		} else if (auto Array = CastField<FArrayProperty>(Property)) {
+			auto Inner = CastField<FObjectPropertyBase>(Array->Inner);
+			if (Inner == nullptr) {
+				continue;
+			}
+
+			FScriptArrayHelper Helper(Array, Array->ContainerPtrToValuePtr<void>(Actor));
+			for (int32 i = 0; i < Helper.Num(); ++i) {
+				Add(Inner->GetObjectPropertyValue(Helper.GetRawPtr(i)));
+			}
+		}
+	}
+
+	if (auto Component = Actor->FindComponentByClass<UActivationNodeComponent>()) {
+		for (AActor* Source : Component->Sources) {
+			if (Source && Source != Actor) {
+				OutSources.AddUnique(Source);
+			}
+		}
+	}
+}
+
+void UActivationGraphSubsystem::BindDispatcher(AActor* Actor) {
+	FMulticastDelegateProperty* Dispatcher = FindDispatcher(Actor, this->DispatcherName);
+	if (Dispatcher == nullptr) {
+		return;
+	}
+
+	auto Proxy = NewObject<UActivationSignalProxy>(this);
+	Proxy->Source = Actor;
+
+	FScriptDelegate Delegate;
+	Delegate.BindUFunction(Proxy, GET_FUNCTION_NAME_CHECKED(UActivationSignalProxy, OnActivation));
+	Dispatcher->AddDelegate(MoveTemp(Delegate), Actor);
+
+	this->Proxies.Add(Proxy);
+}
+
+bool UActivationGraphSubsystem::ReadState(const AActor* Actor) const {
+	auto State = FindFProperty<FBoolProperty>(Actor->GetClass(), this->StateProperty);
+	return State ? State->GetPropertyValue_InContainer(Actor) : false;
+}
+
+bool UActivationGraphSubsystem::ListensToSources(const FNode& Node, const AActor* Actor) const {
+	const int32* Input = this->Inputs.GetData() + Node.FirstInput;
+	for (int32 j = 0; j < Node.NumInputs; ++j) {
+		AActor* Source = this->Nodes[Input[j]].Actor.Get();
+		FMulticastDelegateProperty* Dispatcher = Source ? FindDispatcher(Source, this->DispatcherName) : nullptr;
+		if (Dispatcher == nullptr) {
+			continue;
+		}
+
+		const FMulticastScriptDelegate* Delegate = Dispatcher->GetMulticastDelegate(Dispatcher->ContainerPtrToValuePtr<void>(Source));
+		if (Delegate && Delegate->GetAllObjects().Contains(Actor)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void UActivationGraphSubsystem::Build() {
+	SCOPE_CYCLE_COUNTER(STAT_ActivationGraphBuild);
+	const double Start = FPlatformTime::Seconds();
+	this->bRebuild = false;
+
+	UWorld* World = this->GetWorld();
+
+	// Signals survive rebuilds, so streaming a sublevel doesn't reset the puzzles already solved.
+	TMap<AActor*, TPair<bool, bool>> Previous;
+	for (const FNode& Node : this->Nodes) {
+		if (AActor* Actor = Node.Actor.Get()) {
+			Previous.Add(Actor, TPair<bool, bool>(Node.bSignal, Node.bOutput));
+		}
+	}
+
+	for (UActivationSignalProxy* Proxy : this->Proxies) {
+		AActor* Source = Proxy->Source.Get();
+		FMulticastDelegateProperty* Dispatcher = Source ? FindDispatcher(Source, this->DispatcherName) : nullptr;
+		if (Dispatcher) {
+			FScriptDelegate Delegate;
+			Delegate.BindUFunction(Proxy, GET_FUNCTION_NAME_CHECKED(UActivationSignalProxy, OnActivation));
+			Dispatcher->RemoveDelegate(Delegate, Source);
+		}
+	}
+	this->Proxies.Reset();
+
+	this->Classes.Reset();
+	for (const FSoftClassPath& Path : this->ActivatorClasses) {
+		if (UClass* Class = Path.TryLoadClass<UObject>()) {
+			this->Classes.Add(Class);
+		}
+	}
+
+	// Gather the nodes and, per node, the nodes feeding it. Sources may add nodes as they are found.
+	TArray<AActor*> Actors;
+	TMap<AActor*, int32> Local;
+	for (TActorIterator<AActor> It(World); It; ++It) {
+		if (this->IsNode(*It)) {
+			Local.Add(*It, Actors.Add(*It));
+		}
+	}
+
+	TArray<TArray<int32>> Sources;
+	for (int32 i = 0; i < Actors.Num(); ++i) {
+		TArray<AActor*> Found;
+		this->CollectSources(Actors[i], Found);
+
+		TArray<int32>& Ids = Sources.AddDefaulted_GetRef();
+		for (AActor* Source : Found) {
+			const int32* Id = Local.Find(Source);
+			Ids.Add(Id ? *Id : Local.Add(Source, Actors.Add(Source)));
+		}
+	}
+
+	// Kahn's algorithm; whatever can't be ordered is on or behind a cycle.
+	TArray<TArray<int32>> Dependents;
+	TArray<int32> Pending;
+	Dependents.SetNum(Actors.Num());
+	Pending.SetNumUninitialized(Actors.Num());
+	for (int32 i = 0; i < Actors.Num(); ++i) {
+		Pending[i] = Sources[i].Num();
+		for (int32 Source : Sources[i]) {
+			Dependents[Source].Add(i);
+		}
+	}
+
+	TArray<int32> Order;
+	Order.Reserve(Actors.Num());
+	for (int32 i = 0; i < Actors.Num(); ++i) {
+		if (Pending[i] == 0) {
+			Order.Add(i);
+		}
+	}
+
+	for (int32 Head = 0; Head < Order.Num(); ++Head) {
+		for (int32 Dependent : Dependents[Order[Head]]) {
+			if (--Pending[Dependent] == 0) {
+				Order.Add(Dependent);
+			}
+		}
+	}
+
+	const int32 Sorted = Order.Num();
+	for (int32 i = 0; i < Actors.Num(); ++i) {
+		if (Pending[i] > 0) {
+			UE_LOG(LogTemp, Warning, TEXT("ActivationGraph: %s is on or behind a cycle, inputs from later nodes are ignored."), *Actors[i]->GetName());
+			Order.Add(i);
+		}
+	}
+
+	TArray<int32> Position;
+	Position.SetNumUninitialized(Actors.Num());
+	for (int32 i = 0; i < Order.Num(); ++i) {
+		Position[Order[i]] = i;
+	}
+
+	// Flatten, keeping only inputs ordered before their node so one forward pass sees settled inputs.
+	this->Nodes.Reset(Order.Num());
+	this->Inputs.Reset();
+	this->Index.Reset();
+
+	for (int32 i = 0; i < Order.Num(); ++i) {
+		AActor* Actor = Actors[Order[i]];
+		UActivationNodeComponent* Component = Actor->FindComponentByClass<UActivationNodeComponent>();
+
+		FNode& Node = this->Nodes.AddDefaulted_GetRef();
+		Node.Actor = Actor;
+		Node.Component = Component;
+		Node.Logic = Component ? Component->Logic : EActivationLogic::ANY;
+		Node.FirstInput = this->Inputs.Num();
+		Node.bDirty = true;
+
+		for (int32 Source : Sources[Order[i]]) {
+			if (Position[Source] < i) {
+				this->Inputs.Add(Position[Source]);
+			}
+		}
+		Node.NumInputs = this->Inputs.Num() - Node.FirstInput;
+
+		// New nodes start from the state they were placed or saved with.
+		const TPair<bool, bool>* State = Previous.Find(Actor);
+		const bool bCurrent = State ? false : this->ReadState(Actor);
+		Node.bSignal = State ? State->Key : bCurrent;
+		Node.bOutput = State ? State->Value : bCurrent;
+
+		this->Index.Add(Actor, i);
+
+		// Only sources drive the graph, the rest are told by it.
+		if (Node.NumInputs == 0) {
+			this->BindDispatcher(Actor);
+		}
+	}
+
+	this->FirstDirty = this->Nodes.Num() > 0 ? 0 : INDEX_NONE;
+
+	this->Stats.Nodes = this->Nodes.Num();
+	this->Stats.Edges = this->Inputs.Num();
+	this->Stats.CyclicNodes = Order.Num() - Sorted;
+	SET_DWORD_STAT(STAT_ActivationGraphNodes, this->Stats.Nodes);
+	SET_DWORD_STAT(STAT_ActivationGraphEdges, this->Stats.Edges);
+
+	UE_LOG(LogTemp, Log, TEXT("ActivationGraph: %d nodes, %d edges, %d on cycles, built in %.2f ms"),
+		this->Stats.Nodes,
+		this->Stats.Edges,
+		this->Stats.CyclicNodes,
+		(FPlatformTime::Seconds() - Start) * 1000.0);
+}
+
+void UActivationGraphSubsystem::SetSignal(AActor* Source, bool bActive) {
+	const int32* Id = this->Index.Find(Source);
+	if (Id == nullptr) {
+		return;
+	}
+
+	FNode& Node = this->Nodes[*Id];
+	if (Node.bSignal == bActive) {
+		return;
+	}
+
+	if (Node.bDirty) {
+		++this->Stats.CoalescedSignals;
+	}
+
+	Node.bSignal = bActive;
+	Node.bDirty = true;
+	this->FirstDirty = this->FirstDirty == INDEX_NONE ? *Id : FMath::Min(this->FirstDirty, *Id);
+}
+
+bool UActivationGraphSubsystem::GetSignal(AActor* Node) const {
+	const int32* Id = this->Index.Find(Node);
+	return Id ? this->Nodes[*Id].bOutput : false;
+}
+
+void UActivationGraphSubsystem::Tick(float DeltaTime) {
+	if (this->bRebuild) {
+		this->Build();
+	}
+
+	this->Propagate();
+}
+
+void UActivationGraphSubsystem::Propagate() {
+	if (this->FirstDirty == INDEX_NONE) {
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ActivationGraphPropagate);
+	const double Start = FPlatformTime::Seconds();
+
+	TBitArray<> Changed(false, this->Nodes.Num());
+	TArray<int32> Notify;
+
+	for (int32 i = this->FirstDirty; i < this->Nodes.Num(); ++i) {
+		FNode& Node = this->Nodes[i];
+		const int32* Input = this->Inputs.GetData() + Node.FirstInput;
+
+		bool bVisit = Node.bDirty;
+		int32 Active = 0;
+		for (int32 j = 0; j < Node.NumInputs; ++j) {
+			bVisit |= (bool) Changed[Input[j]];
+			Active += this->Nodes[Input[j]].bOutput ? 1 : 0;
+		}
+
+		if (!bVisit) {
+			continue;
+		}
+
+		INC_DWORD_STAT(STAT_ActivationGraphVisited);
+		Node.bDirty = false;
+
+		bool bOutput = Node.bSignal;
+		if (Node.NumInputs > 0) {
+			switch (Node.Logic) {
+			case EActivationLogic::ANY:
+				bOutput = Active > 0;
+				break;
+			case EActivationLogic::ALL:
+				bOutput = Active == Node.NumInputs;
+				break;
+			case EActivationLogic::NONE:
+				bOutput = Active == 0;
+				break;
+			}
+		}
+
+		if (bOutput != Node.bOutput) {
+			Node.bOutput = bOutput;
+			Changed[i] = true;
+			Notify.Add(i);
+		}
+	}
+
+	this->FirstDirty = INDEX_NONE;
+
+	const double Elapsed = (FPlatformTime::Seconds() - Start) * 1000.0;
+	++this->Stats.Propagations;
+	this->Stats.LastPropagateMs = Elapsed;
+	this->Stats.MaxPropagateMs = FMath::Max(this->Stats.MaxPropagateMs, Elapsed);
+
+	// Told after the pass, so signals set by the listeners wait for the next propagation.
+	for (int32 i : Notify) {
+		const FNode& Node = this->Nodes[i];
+		AActor* Actor = Node.Actor.Get();
+		if (Actor == nullptr) {
+			continue;
+		}
+
+		++this->Stats.Notifications;
+
+		// Sources already know their state, and nodes bound to their sources' dispatchers were told by them.
+		if (Node.NumInputs > 0 && !this->ListensToSources(Node, Actor)) {
+			UPlaygroundStatics::CallBlueprintFunctionWithBool(Actor, this->SignalFunction, Node.bOutput);
+		}
+
+		if (UActivationNodeComponent* Component = Node.Component.Get()) {
+			Component->OnSignalChanged.Broadcast(Node.bOutput);
+		}
+	}
+}
+
+TStatId UActivationGraphSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UActivationGraphSubsystem, STATGROUP_Tickables);
+}
+
+void UActivationGraphSubsystem::LogGraph() const {
+	for (int32 i = 0; i < this->Nodes.Num(); ++i) {
+		const FNode& Node = this->Nodes[i];
+
+		FString Sources;
+		for (int32 j = 0; j < Node.NumInputs; ++j) {
+			Sources += FString::Printf(TEXT(" %d"), this->Inputs[Node.FirstInput + j]);
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("%4d %-32s %-4s %s <-%s"),
+			i,
+			Node.Actor.IsValid() ? *Node.Actor->GetName() : TEXT("(destroyed)"),
+			*UEnum::GetValueAsString(Node.Logic),
+			Node.bOutput ? TEXT("on ") : TEXT("off"),
+			*Sources);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("ActivationGraph: %d nodes, %d edges, %d on cycles, %d propagations (%d signals coalesced, %d notifications), last %.3f ms, max %.3f ms"),
+		this->Stats.Nodes,
+		this->Stats.Edges,
+		this->Stats.CyclicNodes,
+		this->Stats.Propagations,
+		this->Stats.CoalescedSignals,
+		this->Stats.Notifications,
+		this->Stats.LastPropagateMs,
+		this->Stats.MaxPropagateMs);
+}
+
+static FAutoConsoleCommandWithWorld GDumpActivationGraphCommand(
+	TEXT("Playground.DumpActivationGraph"),
+	TEXT("Logs the activation graph in propagation order, its size and propagation times."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World) {
+		if (auto Subsystem = UWorld::GetSubsystem<UActivationGraphSubsystem>(World)) {
+			Subsystem->LogGraph();
+		}
+	}));
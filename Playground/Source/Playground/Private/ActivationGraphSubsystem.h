@@ -0,0 +1,145 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ActivationNodeComponent.h"
+#include "ActivationGraphSubsystem.generated.h"
+
+struct FActivationGraphStats {
+	int32 Nodes = 0;
+	int32 Edges = 0;
+	// Nodes left out of the sort because they were on a cycle, their inputs are ignored.
+	int32 CyclicNodes = 0;
+	int32 Propagations = 0;
+	// Signals set while a propagation was pending, merged into it.
+	int32 CoalescedSignals = 0;
+	int32 Notifications = 0;
+	double LastPropagateMs = 0.0;
+	double MaxPropagateMs = 0.0;
+};
+
+/**
+ * Receives a source's ActivationListeners broadcast and forwards it to the graph.
+ */
+UCLASS()
+class UActivationSignalProxy : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	TWeakObjectPtr<AActor> Source;
+
+	UFUNCTION()
+	void OnActivation(bool ActivatedQ);
+};
+
+/**
+ * Lever, pressure plate, elevator and gate chains compiled into a flat array in topological order.
+ * Built when the level loads and when sublevels or World Partition cells holding activators stream in or out. A node's sources are the activators
+ * (ABP_AbstractActivator, BPI_Activator, BPI_Trigger) listed in its SourceProperties variables, such as
+ * BP_ElevatorSystem's TargetArray, plus any UActivationNodeComponent sources. Other variables, like the
+ * Target a pressure plate drives, point the other way and are not followed. Links that close a cycle
+ * are reported and ignored. Nodes start from their own StateProperty.
+ *
+ * Sources set their signal through SetSignal, or by broadcasting ActivationListeners as before. Signals
+ * are only recorded until the next tick, which propagates every change in one pass over the array, so a
+ * cascade through many hops in one frame costs one visit per node. Nodes whose value changed are then
+ * told through their Set Activation State function, unless they still listen to their sources' dispatchers
+ * themselves, and UActivationNodeComponent::OnSignalChanged.
+ */
+UCLASS(Config=Game)
+class UActivationGraphSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	struct FNode {
+		TWeakObjectPtr<AActor> Actor;
+		TWeakObjectPtr<UActivationNodeComponent> Component;
+		EActivationLogic Logic;
+		// Range in Inputs, all of which come before this node.
+		int32 FirstInput;
+		int32 NumInputs;
+		// Signal set by the node itself, used when it has no inputs.
+		bool bSignal;
+		bool bOutput;
+		bool bDirty;
+	};
+
+	TArray<FNode> Nodes;
+	TArray<int32> Inputs;
+	TMap<TWeakObjectPtr<AActor>, int32> Index;
+	// Lowest dirty node, INDEX_NONE when nothing is pending.
+	int32 FirstDirty = INDEX_NONE;
+	bool bRebuild = false;
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+
+	UPROPERTY()
+	TArray<TObjectPtr<UActivationSignalProxy>> Proxies;
+
+	// ActivatorClasses loaded by the last Build, also used to check streamed levels.
+	UPROPERTY()
+	TArray<TObjectPtr<UClass>> Classes;
+
+	FActivationGraphStats Stats;
+
+public:
+	/** Classes and interfaces whose actors are nodes of the graph. **/
+	UPROPERTY(Config, EditAnywhere, Category = "Activation")
+	TArray<FSoftClassPath> ActivatorClasses = {
+		FSoftClassPath(TEXT("/Game/Assets/Interface/ABP_AbstractActivator.ABP_AbstractActivator_C")),
+		FSoftClassPath(TEXT("/Game/Assets/Interface/BPI_Activator.BPI_Activator_C")),
+		FSoftClassPath(TEXT("/Game/Assets/Interface/BPI_Trigger.BPI_Trigger_C")),
+	};
+
+	/** Variables, object or array of objects, that list the activators driving a node. **/
+	UPROPERTY(Config, EditAnywhere, Category = "Activation")
+	TArray<FName> SourceProperties = { TEXT("TargetArray") };
+
+	/** Bool variable holding a node's state, read when it joins the graph. **/
+	UPROPERTY(Config, EditAnywhere, Category = "Activation")
+	FName StateProperty = TEXT("ActivatedQ");
+
+	/** Event dispatcher sources broadcast their state on. **/
+	UPROPERTY(Config, EditAnywhere, Category = "Activation")
+	FName DispatcherName = TEXT("ActivationListeners");
+
+	/** Function called on nodes whose signal changed, with the new signal. **/
+	UPROPERTY(Config, EditAnywhere, Category = "Activation")
+	FName SignalFunction = TEXT("Set Activation State");
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Compiles the graph from every activator in the world, keeping current signals. **/
+	void Build();
+
+	/** Sets a source's signal, propagated on the next tick. Repeated sets in a frame coalesce. **/
+	UFUNCTION(BlueprintCallable, Category = "Activation")
+	void SetSignal(AActor* Source, bool bActive);
+
+	UFUNCTION(BlueprintPure, Category = "Activation")
+	bool GetSignal(AActor* Node) const;
+
+	/** Propagates pending signals now instead of on the next tick. **/
+	void Propagate();
+
+	FORCEINLINE const FActivationGraphStats& GetStats() const { return this->Stats; }
+
+	/** Logs the nodes in propagation order with their inputs and signals. **/
+	void LogGraph() const;
+
+private:
+	bool IsActivator(const AActor* Actor) const;
+	bool IsNode(const AActor* Actor) const;
+	void CollectSources(AActor* Actor, TArray<AActor*>& OutSources) const;
+	void BindDispatcher(AActor* Actor);
+	bool ReadState(const AActor* Actor) const;
+	bool ListensToSources(const FNode& Node, const AActor* Actor) const;
+	void OnLevelsChanged(ULevel* Level, UWorld* InWorld);
+};
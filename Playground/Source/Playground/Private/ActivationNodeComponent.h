@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "ActivationNodeComponent.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FActivationSignalEvent, bool, bActive);
+
+UENUM(BlueprintType)
+enum class EActivationLogic : uint8 {
+	/** Active while any source is, e.g. a gate opened by either of two levers. **/
+	ANY,
+	/** Active while every source is, e.g. an elevator that needs all its plates held. **/
+	ALL,
+	/** Active while no source is. **/
+	NONE,
+};
+
+/**
+ * Explicit node of UActivationGraphSubsystem's graph, for actors that need more than the links found in
+ * their source variables: extra sources, a logic other than ANY, or a native signal event.
+ */
+UCLASS(ClassGroup=(Playground), meta=(BlueprintSpawnableComponent))
+class UActivationNodeComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Activation")
+	EActivationLogic Logic = EActivationLogic::ANY;
+
+	/** Activators driving this one, in addition to those in the owner's source variables. **/
+	UPROPERTY(EditInstanceOnly, BlueprintReadOnly, Category = "Activation")
+	TArray<TObjectPtr<AActor>> Sources;
+
+	/** Broadcast after propagation when the owner's signal changed. **/
+	UPROPERTY(BlueprintAssignable, Category = "Activation")
+	FActivationSignalEvent OnSignalChanged;
+};
@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BTDecorator_FactionResponse.h"
+#include "AIController.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+
+UBTDecorator_FactionResponse::UBTDecorator_FactionResponse() {
+	this->NodeName = TEXT("Check Faction Response");
+	// Only the target matters, the base class' default filters would also accept vectors.
+	this->BlackboardKey.AllowedTypes.Reset();
+	this->BlackboardKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UBTDecorator_FactionResponse, BlackboardKey), AActor::StaticClass());
+}
+
+bool UBTDecorator_FactionResponse::CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const {
+	auto Controller = OwnerComp.GetAIOwner();
+	auto Blackboard = OwnerComp.GetBlackboardComponent();
+	auto Factions = UWorld::GetSubsystem<UFactionSubsystem>(OwnerComp.GetWorld());
+
+	if (Controller == nullptr || Blackboard == nullptr || Factions == nullptr) {
+		return false;
+	}
+
+	auto Target = Cast<AActor>(Blackboard->GetValue<UBlackboardKeyType_Object>(this->BlackboardKey.GetSelectedKeyID()));
+	if (Target == nullptr) {
+		// GetActorResponse treats a missing actor as NEUTRAL, which would pass a neutral check.
+		return false;
+	}
+
+	return Factions->GetActorResponse(Controller->GetPawn(), Target) == this->Response;
+}
+
+FString UBTDecorator_FactionResponse::GetStaticDescription() const {
+	return FString::Printf(TEXT("%s is %s"),
+		*Super::GetStaticDescription(),
+		*UEnum::GetDisplayValueAsText(this->Response).ToString());
+}
@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/Decorators/BTDecorator_BlackboardBase.h"
+#include "FactionSubsystem.h"
+#include "BTDecorator_FactionResponse.generated.h"
+
+/**
+ * Native BTD_CheckFactionResponse. Passes when the relation between the controlled pawn and the
+ * blackboard target is Response, looked up in UFactionSubsystem, and fails without a target. Observer
+ * aborts re-evaluate it when the target key changes.
+ */
+UCLASS()
+class UBTDecorator_FactionResponse : public UBTDecorator_BlackboardBase
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Factions")
+	EFactionResponse Response = EFactionResponse::HOSTILE;
+
+public:
+	UBTDecorator_FactionResponse();
+
+	virtual FString GetStaticDescription() const override;
+
+protected:
+	virtual bool CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const override;
+};
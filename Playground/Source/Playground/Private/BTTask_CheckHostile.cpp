@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BTTask_CheckHostile.h"
+#include "FactionSubsystem.h"
+#include "AIController.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+
+UBTTask_CheckHostile::UBTTask_CheckHostile() {
+	this->NodeName = TEXT("Check Hostile");
+	this->TargetKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UBTTask_CheckHostile, TargetKey), AActor::StaticClass());
+}
+
+void UBTTask_CheckHostile::InitializeFromAsset(UBehaviorTree& Asset) {
+	Super::InitializeFromAsset(Asset);
+
+	if (UBlackboardData* Blackboard = this->GetBlackboardAsset()) {
+		this->TargetKey.ResolveSelectedKey(*Blackboard);
+	}
+}
+
+EBTNodeResult::Type UBTTask_CheckHostile::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) {
+	auto Controller = OwnerComp.GetAIOwner();
+	auto Blackboard = OwnerComp.GetBlackboardComponent();
+	auto Factions = UWorld::GetSubsystem<UFactionSubsystem>(OwnerComp.GetWorld());
+
+	if (Controller == nullptr || Blackboard == nullptr || Factions == nullptr) {
+		return EBTNodeResult::Failed;
+	}
+
+	AActor* Target = Factions->FindNearestHostile(Controller->GetPawn(), this->Radius);
+	Blackboard->SetValue<UBlackboardKeyType_Object>(this->TargetKey.GetSelectedKeyID(), Target);
+
+	return Target ? EBTNodeResult::Succeeded : EBTNodeResult::Failed;
+}
+
+FString UBTTask_CheckHostile::GetStaticDescription() const {
+	return FString::Printf(TEXT("%s: nearest hostile within %.0f into %s"),
+		*Super::GetStaticDescription(),
+		this->Radius,
+		*this->TargetKey.SelectedKeyName.ToString());
+}
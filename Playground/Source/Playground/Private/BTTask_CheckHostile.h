@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTTaskNode.h"
+#include "BTTask_CheckHostile.generated.h"
+
+/**
+ * Native BTT_CheckHostile. Writes the nearest actor hostile to the controlled pawn within Radius into
+ * TargetKey and succeeds, or clears the key and fails if there is none.
+ */
+UCLASS()
+class UBTTask_CheckHostile : public UBTTaskNode
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Blackboard")
+	FBlackboardKeySelector TargetKey;
+
+	UPROPERTY(EditAnywhere, Category = "Factions", meta = (ClampMin = "0"))
+	float Radius = 2000.0f;
+
+public:
+	UBTTask_CheckHostile();
+
+	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+	virtual FString GetStaticDescription() const override;
+
+protected:
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+};
@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "BatchDamageable.generated.h"
+
+UINTERFACE(MinimalAPI, Blueprintable)
+class UBatchDamageable : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Receiver of damage evaluated by FSpellDamageBatch. Targets that don't implement this get BPI_Damageable's
+ * Take Damage, or have it queued on their UStatComponent, or get the engine's ApplyDamage as a last resort,
+ * with no resistances in every case.
+ */
+class IBatchDamageable
+{
+	GENERATED_BODY()
+
+public:
+	/** Fraction of fire (X) and sharp (Y) damage that is resisted, 0 to 1. Read once per hit target. **/
+	UFUNCTION(BlueprintNativeEvent, Category = "Damage")
+	FVector2D GetDamageResistance() const;
+
+	/** Final damage after scaling, resistance and falloff. **/
+	UFUNCTION(BlueprintNativeEvent, Category = "Damage")
+	void ReceiveBatchedDamage(float Damage, AActor* DamageCauser, AController* Instigator);
+};
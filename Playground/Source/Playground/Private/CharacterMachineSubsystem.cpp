@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CharacterMachineSubsystem.h"
+#include "Async/ParallelFor.h"
+
+void UCharacterMachineSubsystem::Register(APlaygroundCharacter* Character) {
+	this->Characters.AddUnique(Character);
+}
+
+void UCharacterMachineSubsystem::Unregister(APlaygroundCharacter* Character) {
+	// Keep the remaining order stable so the apply phase stays deterministic.
+	this->Characters.Remove(Character);
+}
+
+void UCharacterMachineSubsystem::Tick(float DeltaTime) {
+	const int32 Count = this->Characters.Num();
+	if (Count == 0) {
+		return;
+	}
+
+	this->Decisions.SetNumUninitialized(Count, false);
+
+	ParallelFor(TEXT("CharacterMachineDecide"), Count, MIN_BATCH_SIZE, [this, DeltaTime](int32 i) {
+		APlaygroundCharacter* Character = this->Characters[i];
+		auto Machine = Character->GetMachine();
+		this->Decisions[i] = { Character, Machine->CurrentState, Machine->DecideStep(DeltaTime) };
+	});
+
+	// Listeners run here and may destroy other characters, so check each before applying.
+	for (const FDecision& Decision : this->Decisions) {
+		if (!IsValid(Decision.Character)) {
+			continue;
+		}
+
+		auto Machine = Decision.Character->GetMachine();
+		if (Machine->CurrentState == Decision.From) {
+			Machine->ApplyStep(Decision.To);
+		} else {
+			Machine->Step(DeltaTime);
+		}
+	}
+}
+
+TStatId UCharacterMachineSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCharacterMachineSubsystem, STATGROUP_Tickables);
+}
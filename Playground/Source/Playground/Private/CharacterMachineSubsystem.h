@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PlaygroundCharacter.h"
+#include "CharacterMachineSubsystem.generated.h"
+
+/**
+ * Steps the state machines of every registered APlaygroundCharacter once per frame. The read-only
+ * decision phase (PlaygroundCharacterStateMachine::DecideStep) runs in parallel on the task graph,
+ * then transitions and their listener callbacks are applied on the game thread in registration order.
+ * Characters whose state a listener changed before their turn are decided again on the game thread.
+ */
+UCLASS()
+class UCharacterMachineSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<APlaygroundCharacter>> Characters;
+
+	struct FDecision {
+		APlaygroundCharacter* Character;
+		// State the decision was made in, a listener applying an earlier decision may have changed it.
+		PlaygroundCharacterStateMachine::PlaygroundCharacterState* From;
+		PlaygroundCharacterStateMachine::PlaygroundCharacterState* To;
+	};
+
+	// Snapshot of the decision phase, so registrations made by listeners don't shift the apply phase.
+	TArray<FDecision> Decisions;
+
+public:
+	/* Characters per task in the parallel phase; below this everything runs on the game thread. */
+	static constexpr int32 MIN_BATCH_SIZE = 32;
+
+	void Register(APlaygroundCharacter* Character);
+	void Unregister(APlaygroundCharacter* Character);
+
+	FORCEINLINE int32 Num() const { return this->Characters.Num(); }
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+};
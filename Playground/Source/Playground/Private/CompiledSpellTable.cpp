@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CompiledSpellTable.h"
+
+void FCompiledSpellTable::Reset() {
+	this->Records.Reset();
+	this->Scaling.Reset();
+	this->RowNames.Reset();
+	this->RowIndices.Reset();
+}
+
+void FCompiledSpellTable::Build(const UDataTable& Table) {
+	this->Reset();
+
+	const TMap<FName, uint8*>& Rows = Table.GetRowMap();
+	this->Records.Reserve(Rows.Num());
+	this->RowNames.Reserve(Rows.Num());
+	this->RowIndices.Reserve(Rows.Num());
+	this->Scaling.Reserve(Rows.Num());
+
+	for (const auto& Pair : Rows) {
+		const FSpellData* Data = reinterpret_cast<const FSpellData*>(Pair.Value);
+
+		this->RowIndices.Add(Pair.Key, this->Records.Num());
+		this->RowNames.Add(Pair.Key);
+		this->Records.Add({ Data->SpellClass.Get(), Data->CastTime, Data->AnimID });
+		this->Scaling.Add({ Data->Scaling.FireScale, Data->Scaling.SharpScale });
+	}
+}
+
+FSpellHandle FCompiledSpellTable::Find(FName Row) const {
+	FSpellHandle Handle;
+	if (const int32* Index = this->RowIndices.Find(Row)) {
+		Handle.Index = *Index;
+	}
+	return Handle;
+}
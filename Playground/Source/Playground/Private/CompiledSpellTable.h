@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "PlaygroundStatics.h"
+#include "CompiledSpellTable.generated.h"
+
+/**
+ * Dense index of a spell in FCompiledSpellTable. Only valid for the table it came from.
+ */
+USTRUCT(BlueprintType)
+struct FSpellHandle
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(BlueprintReadOnly, Category = "Spells")
+	int32 Index = INDEX_NONE;
+
+	FORCEINLINE bool IsValid() const { return this->Index != INDEX_NONE; }
+	FORCEINLINE bool operator==(const FSpellHandle& Other) const { return this->Index == Other.Index; }
+};
+
+/**
+ * Hot, per cast data of a spell. The spell class is kept alive by the source DataTable.
+ */
+struct FSpellRecord
+{
+	UClass* SpellClass;
+	float CastTime;
+	ECastAnimationID AnimID;
+};
+
+/**
+ * Fire and sharp multipliers of a spell's FScalingData.
+ */
+struct FSpellScaling
+{
+	float Fire;
+	float Sharp;
+};
+
+/**
+ * Flattened copy of the spell DataTable built once at load. Records and scaling live in contiguous
+ * arrays addressed by FSpellHandle, so a cast is an array index instead of a row name hash and a
+ * reflection read.
+ */
+class FCompiledSpellTable
+{
+public:
+	void Build(const UDataTable& Table);
+	void Reset();
+
+	FSpellHandle Find(FName Row) const;
+
+	FORCEINLINE bool IsValid(FSpellHandle Handle) const { return this->Records.IsValidIndex(Handle.Index); }
+	FORCEINLINE int32 Num() const { return this->Records.Num(); }
+
+	FORCEINLINE const FSpellRecord& Get(FSpellHandle Handle) const { return this->Records[Handle.Index]; }
+	FORCEINLINE FName GetRowName(FSpellHandle Handle) const { return this->RowNames[Handle.Index]; }
+
+	FORCEINLINE const FSpellScaling& GetScaling(FSpellHandle Handle) const { return this->Scaling[Handle.Index]; }
+
+private:
+	TArray<FSpellRecord> Records;
+	TArray<FSpellScaling> Scaling;
+	// Cold data, only used to resolve handles.
+	TArray<FName> RowNames;
+	TMap<FName, int32> RowIndices;
+};
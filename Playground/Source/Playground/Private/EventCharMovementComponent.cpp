@@ -2,6 +2,22 @@
 
 
 #include "EventCharMovementComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Misc/DateTime.h"
+#include "UObject/UObjectIterator.h"
+#include "Engine/World.h"
+
+static int32 GMovementTelemetryEnabled = 0;
+static FAutoConsoleVariableRef CVarMovementTelemetry(
+	TEXT("Playground.MovementTelemetry"),
+	GMovementTelemetryEnabled,
+	TEXT("Records movement updates of event movement components into a per-component ring buffer and streams them to Saved/Profiling."));
+
+static FString MovementTelemetryDir() {
+	return FPaths::Combine(FPaths::ProfilingDir(), TEXT("MovementTelemetry"));
+}
 
 void UEventCharMovementComponent::OnMovementModeChanged(EMovementMode Previous, uint8 PreviousCustom) {
 	Super::OnMovementModeChanged(Previous, PreviousCustom);
@@ -9,8 +25,77 @@ void UEventCharMovementComponent::OnMovementModeChanged(EMovementMode Previous,
 }
 
 void UEventCharMovementComponent::OnMovementUpdated(float DeltaSeconds, const FVector& OldLocation, const FVector& OldVelocity) {
-	if (GEngine)
-		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Yellow, 
-			FString::Printf(TEXT("Z-velocity: %f"), OldVelocity.Z));
+	if (GMovementTelemetryEnabled) {
+		this->RecordTelemetry(DeltaSeconds, OldLocation);
+	} else if (this->Telemetry.IsValid() && this->Telemetry->IsStreaming()) {
+		this->Telemetry->StopStream();
+	}
 	Super::OnMovementUpdated(DeltaSeconds, OldLocation, OldVelocity);
-}
\ No newline at end of file
+}
+
+void UEventCharMovementComponent::RecordTelemetry(float DeltaSeconds, const FVector& OldLocation) {
+	if (!this->Telemetry.IsValid()) {
+		this->Telemetry = MakeUnique<FMovementTelemetry>();
+	}
+
+	if (!this->Telemetry->IsStreaming()) {
+		const FString Dir = MovementTelemetryDir();
+		const FString Path = FPaths::Combine(Dir, FString::Printf(TEXT("%s_%s_stream.bin"),
+			*GetNameSafe(this->GetOwner()), *FDateTime::Now().ToString()));
+		IFileManager::Get().MakeDirectory(*Dir, true);
+
+		if (this->Telemetry->StartStream(Path)) {
+			UE_LOG(LogTemp, Log, TEXT("Streaming movement telemetry to %s"), *Path);
+		}
+	}
+
+	FMovementSample Sample;
+	Sample.Frame = (uint32) GFrameCounter;
+	Sample.DeltaTime = DeltaSeconds;
+	Sample.OldLocation = FVector3f(OldLocation);
+	Sample.NewLocation = FVector3f(this->UpdatedComponent ? this->UpdatedComponent->GetComponentLocation() : OldLocation);
+	Sample.Velocity = FVector3f(this->Velocity);
+	Sample.MovementMode = this->MovementMode;
+	Sample.CustomMovementMode = this->CustomMovementMode;
+	this->Telemetry->Record(Sample);
+}
+
+void UEventCharMovementComponent::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	if (this->Telemetry.IsValid()) {
+		this->Telemetry->StopStream();
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+bool UEventCharMovementComponent::DumpTelemetry(const FString& Path, bool bBinary) const {
+	if (!this->Telemetry.IsValid()) {
+		return false;
+	}
+
+	return bBinary ? this->Telemetry->SaveBinary(Path) : this->Telemetry->SaveCSV(Path);
+}
+
+static void DumpMovementTelemetry(const TArray<FString>& Args, UWorld* World) {
+	const bool bBinary = Args.Num() > 0 && Args[0].Equals(TEXT("bin"), ESearchCase::IgnoreCase);
+	const FString Dir = MovementTelemetryDir();
+	const FString Stamp = FDateTime::Now().ToString();
+	IFileManager::Get().MakeDirectory(*Dir, true);
+
+	for (TObjectIterator<UEventCharMovementComponent> It; It; ++It) {
+		if (It->GetWorld() != World) {
+			continue;
+		}
+
+		const FString Path = FPaths::Combine(Dir, FString::Printf(TEXT("%s_%s.%s"),
+			*It->GetOwner()->GetName(), *Stamp, bBinary ? TEXT("bin") : TEXT("csv")));
+
+		if (It->DumpTelemetry(Path, bBinary)) {
+			UE_LOG(LogTemp, Log, TEXT("Wrote movement telemetry to %s"), *Path);
+		}
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GDumpMovementTelemetryCommand(
+	TEXT("Playground.DumpMovementTelemetry"),
+	TEXT("Writes the recorded movement telemetry of every event movement component to Saved/Profiling. Args: [csv|bin]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&DumpMovementTelemetry));
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Delegates/Delegate.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "MovementTelemetry.h"
 #include "EventCharMovementComponent.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(
@@ -21,12 +22,21 @@ class UEventCharMovementComponent : public UCharacterMovementComponent
 {
 	GENERATED_BODY()
 
+	/* Allocated the first time a sample is recorded, see Playground.MovementTelemetry. */
+	TUniquePtr<FMovementTelemetry> Telemetry;
+
+	void RecordTelemetry(float DeltaSeconds, const FVector& OldLocation);
+
 protected:	
 	virtual void OnMovementModeChanged(EMovementMode Previous, uint8 PreviousCustom) override;
 	virtual void OnMovementUpdated(float DeltaSeconds, const FVector& OldLocation, const FVector& OldVelocity) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:
 
 	UPROPERTY(BlueprintReadWrite, BlueprintAssignable, Category="Movement")
 	FMovementModeChanged MovementModeChangedEvent;
+
+	/** Writes the recorded movement samples as CSV or packed binary. Returns false if nothing was recorded. **/
+	bool DumpTelemetry(const FString& Path, bool bBinary) const;
 };
@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FactionComponent.h"
+#include "Engine/World.h"
+
+void UFactionComponent::BeginPlay() {
+	Super::BeginPlay();
+
+	if (auto Factions = UWorld::GetSubsystem<UFactionSubsystem>(this->GetWorld())) {
+		Factions->Register(this);
+	}
+}
+
+void UFactionComponent::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	if (auto Factions = UWorld::GetSubsystem<UFactionSubsystem>(this->GetWorld())) {
+		Factions->Unregister(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UFactionComponent::SetFaction(EPlaygroundFaction NewFaction) {
+	if (NewFaction == this->Faction || NewFaction >= EPlaygroundFaction::COUNT) {
+		return;
+	}
+
+	this->Faction = NewFaction;
+
+	// Members are kept per faction, so a registered owner moves to its new faction's grid.
+	if (this->HasBegunPlay()) {
+		if (auto Factions = UWorld::GetSubsystem<UFactionSubsystem>(this->GetWorld())) {
+			Factions->Unregister(this);
+			Factions->Register(this);
+		}
+	}
+}
+
+bool UFactionComponent::GetActorFaction(const AActor* Actor, EPlaygroundFaction& Out) {
+	if (Actor == nullptr) {
+		return false;
+	}
+
+	if (auto Component = Actor->FindComponentByClass<UFactionComponent>()) {
+		Out = Component->Faction;
+		return true;
+	}
+
+	return false;
+}
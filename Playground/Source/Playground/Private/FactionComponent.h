@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "FactionSubsystem.h"
+#include "FactionComponent.generated.h"
+
+/**
+ * Faction of its owner, registered with UFactionSubsystem while the owner is in play.
+ */
+UCLASS(ClassGroup=(Playground), meta=(BlueprintSpawnableComponent))
+class UFactionComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Factions")
+	EPlaygroundFaction Faction = EPlaygroundFaction::ANTI_PLAYER;
+
+public:
+	UFUNCTION(BlueprintPure, Category = "Factions")
+	EPlaygroundFaction GetFaction() const { return this->Faction; }
+
+	UFUNCTION(BlueprintCallable, Category = "Factions")
+	void SetFaction(EPlaygroundFaction NewFaction);
+
+	/** Faction of an actor's UFactionComponent. Returns false if it has none. **/
+	static bool GetActorFaction(const AActor* Actor, EPlaygroundFaction& Out);
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+};
@@ -0,0 +1,194 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FactionSubsystem.h"
+#include "FactionComponent.h"
+#include "Components/SceneComponent.h"
+#include "GameFramework/Actor.h"
+
+DECLARE_STATS_GROUP(TEXT("Factions"), STATGROUP_Factions, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Hostile Query"), STAT_FactionHostileQuery, STATGROUP_Factions);
+
+void UFactionSubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+	Super::Initialize(Collection);
+
+	for (FFactionMembers& Faction : this->Members) {
+		Faction.Grid.Reset(this->CellSize);
+	}
+
+	for (int32 i = 0; i < (int32) EPlaygroundFaction::COUNT; ++i) {
+		this->SetResponse((EPlaygroundFaction) i, (EPlaygroundFaction) i, EFactionResponse::FRIENDLY);
+	}
+	this->SetResponse(EPlaygroundFaction::PLAYER, EPlaygroundFaction::ANTI_PLAYER, EFactionResponse::HOSTILE);
+
+	for (const FFactionRelation& Relation : this->Relations) {
+		this->SetResponse(Relation.A, Relation.B, Relation.Response);
+	}
+}
+
+void UFactionSubsystem::Deinitialize() {
+	for (const auto& Pair : this->Registered) {
+		const AActor* Actor = this->Members[(int32) Pair.Value.Faction].Actors[Pair.Value.Id].Get();
+		if (Actor && Actor->GetRootComponent()) {
+			Actor->GetRootComponent()->TransformUpdated.Remove(Pair.Value.Handle);
+		}
+	}
+
+	for (FFactionMembers& Faction : this->Members) {
+		Faction.Grid.Reset(this->CellSize);
+		Faction.Actors.Reset();
+	}
+
+	this->Registered.Reset();
+	Super::Deinitialize();
+}
+
+void UFactionSubsystem::SetResponse(EPlaygroundFaction A, EPlaygroundFaction B, EFactionResponse Response) {
+	if (A >= EPlaygroundFaction::COUNT || B >= EPlaygroundFaction::COUNT) {
+		return;
+	}
+
+	const int32 IA = (int32) A;
+	const int32 IB = (int32) B;
+	const uint64 BitA = 1ull << IA;
+	const uint64 BitB = 1ull << IB;
+
+	this->Hostile[IA] &= ~BitB;
+	this->Hostile[IB] &= ~BitA;
+	this->Friendly[IA] &= ~BitB;
+	this->Friendly[IB] &= ~BitA;
+
+	if (Response == EFactionResponse::HOSTILE) {
+		this->Hostile[IA] |= BitB;
+		this->Hostile[IB] |= BitA;
+	} else if (Response == EFactionResponse::FRIENDLY) {
+		this->Friendly[IA] |= BitB;
+		this->Friendly[IB] |= BitA;
+	}
+}
+
+EFactionResponse UFactionSubsystem::GetResponse(EPlaygroundFaction A, EPlaygroundFaction B) const {
+	if (A >= EPlaygroundFaction::COUNT || B >= EPlaygroundFaction::COUNT) {
+		return EFactionResponse::NEUTRAL;
+	}
+
+	if (this->IsHostile(A, B)) {
+		return EFactionResponse::HOSTILE;
+	} else if ((this->Friendly[(int32) A] >> (int32) B) & 1) {
+		return EFactionResponse::FRIENDLY;
+	}
+
+	return EFactionResponse::NEUTRAL;
+}
+
+EFactionResponse UFactionSubsystem::GetActorResponse(const AActor* A, const AActor* B) const {
+	EPlaygroundFaction FA, FB;
+
+	if (UFactionComponent::GetActorFaction(A, FA) && UFactionComponent::GetActorFaction(B, FB)) {
+		return this->GetResponse(FA, FB);
+	}
+
+	return EFactionResponse::NEUTRAL;
+}
+
+void UFactionSubsystem::Register(UFactionComponent* Component) {
+	AActor* Actor = Component ? Component->GetOwner() : nullptr;
+	const EPlaygroundFaction Faction = Component ? Component->GetFaction() : EPlaygroundFaction::COUNT;
+	if (Actor == nullptr || Faction >= EPlaygroundFaction::COUNT || this->Registered.Contains(Component)) {
+		return;
+	}
+
+	FFactionMembers& Members = this->Members[(int32) Faction];
+	const int32 Id = Members.Grid.Add(Actor->GetActorLocation());
+	if (!Members.Actors.IsValidIndex(Id)) {
+		Members.Actors.SetNum(Id + 1);
+	}
+	Members.Actors[Id] = Actor;
+
+	FMember& Member = this->Registered.Add(Component, { Faction, Id, FDelegateHandle() });
+	if (USceneComponent* Root = Actor->GetRootComponent()) {
+		Member.Handle = Root->TransformUpdated.AddUObject(this, &UFactionSubsystem::OnTransformUpdated, Faction, Id);
+	}
+}
+
+void UFactionSubsystem::Unregister(UFactionComponent* Component) {
+	FMember Member;
+	if (!this->Registered.RemoveAndCopyValue(Component, Member)) {
+		return;
+	}
+
+	FFactionMembers& Members = this->Members[(int32) Member.Faction];
+	const AActor* Actor = Members.Actors[Member.Id].Get();
+	if (Actor && Actor->GetRootComponent()) {
+		Actor->GetRootComponent()->TransformUpdated.Remove(Member.Handle);
+	}
+
+	Members.Actors[Member.Id] = nullptr;
+	Members.Grid.Remove(Member.Id);
+}
+
+void UFactionSubsystem::OnTransformUpdated(USceneComponent* Component, EUpdateTransformFlags Flags,
+	ETeleportType Teleport, EPlaygroundFaction Faction, int32 Id)
+{
+	this->Members[(int32) Faction].Grid.Move(Id, Component->GetComponentLocation());
+}
+
+void UFactionSubsystem::GetHostileActorsNear(EPlaygroundFaction Faction, const FVector& Location, float Radius,
+	TArray<AActor*>& Out) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_FactionHostileQuery);
+
+	if (Faction >= EPlaygroundFaction::COUNT) {
+		return;
+	}
+
+	// Only the grids of hostile factions are visited, one per set bit of the row.
+	TArray<int32> Found;
+	for (uint64 Mask = this->Hostile[(int32) Faction]; Mask != 0; Mask &= Mask - 1) {
+		const int32 Other = (int32) FMath::CountTrailingZeros64(Mask);
+		if (Other >= (int32) EPlaygroundFaction::COUNT) {
+			break;
+		}
+
+		const FFactionMembers& Members = this->Members[Other];
+		Found.Reset();
+		Members.Grid.QueryRadius(Location, Radius, Found);
+
+		for (int32 Id : Found) {
+			if (AActor* Actor = Members.Actors[Id].Get()) {
+				Out.Add(Actor);
+			}
+		}
+	}
+}
+
+TArray<AActor*> UFactionSubsystem::GetHostileActors(const AActor* Observer, FVector Location, float Radius) const {
+	TArray<AActor*> Out;
+	EPlaygroundFaction Faction;
+
+	if (UFactionComponent::GetActorFaction(Observer, Faction)) {
+		this->GetHostileActorsNear(Faction, Location, Radius, Out);
+	}
+
+	return Out;
+}
+
+AActor* UFactionSubsystem::FindNearestHostile(const AActor* Observer, float Radius) const {
+	if (Observer == nullptr) {
+		return nullptr;
+	}
+
+	const FVector Location = Observer->GetActorLocation();
+	AActor* Nearest = nullptr;
+	float NearestDistance = MAX_flt;
+
+	for (AActor* Actor : this->GetHostileActors(Observer, Location, Radius)) {
+		const float Distance = FVector::DistSquared(Actor->GetActorLocation(), Location);
+		if (Distance < NearestDistance) {
+			Nearest = Actor;
+			NearestDistance = Distance;
+		}
+	}
+
+	return Nearest;
+}
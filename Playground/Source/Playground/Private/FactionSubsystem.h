@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TargetHashGrid.h"
+#include "FactionSubsystem.generated.h"
+
+class UFactionComponent;
+
+/**
+ * Native mirror of BP_Factions. Values index the relation matrix, so new factions go at the end.
+ */
+UENUM(BlueprintType)
+enum class EPlaygroundFaction : uint8 {
+	PLAYER             UMETA(DisplayName = "Player"),
+	ANTI_PLAYER        UMETA(DisplayName = "AntiPlayer"),
+	COUNT              UMETA(Hidden),
+};
+
+/**
+ * Native mirror of BP_FactionResponse.
+ */
+UENUM(BlueprintType)
+enum class EFactionResponse : uint8 {
+	FRIENDLY           UMETA(DisplayName = "Friendly"),
+	NEUTRAL            UMETA(DisplayName = "Neutral"),
+	HOSTILE            UMETA(DisplayName = "Hostile"),
+};
+
+USTRUCT(BlueprintType)
+struct FFactionRelation
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Factions")
+	EPlaygroundFaction A = EPlaygroundFaction::PLAYER;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Factions")
+	EPlaygroundFaction B = EPlaygroundFaction::PLAYER;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Factions")
+	EFactionResponse Response = EFactionResponse::NEUTRAL;
+};
+
+/**
+ * Relations between factions, stored as two bit matrices (hostile and friendly, anything else is neutral)
+ * with one 64 bit row per faction, so a relation query is a shift and a mask. Members of each faction are
+ * kept in a spatial hash of their own, so batch queries such as every hostile actor near a point walk the
+ * set bits of the hostile row and only visit the grid cells around the point in those factions. Unlike
+ * UTargetGridSubsystem's targets, this includes the player, allies and neutral actors.
+ *
+ * Every faction is friendly to itself and Player and AntiPlayer are hostile; Relations in the Game config
+ * is applied on top of that.
+ */
+UCLASS(Config=Game)
+class UFactionSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static constexpr int32 MAX_FACTIONS = 64;
+	static_assert((int32) EPlaygroundFaction::COUNT <= MAX_FACTIONS, "Faction rows are 64 bits wide.");
+
+private:
+	struct FFactionMembers {
+		FTargetHashGrid Grid;
+		// Indexed by grid id.
+		TArray<TWeakObjectPtr<AActor>> Actors;
+	};
+
+	struct FMember {
+		EPlaygroundFaction Faction;
+		int32 Id;
+		FDelegateHandle Handle;
+	};
+
+	uint64 Hostile[MAX_FACTIONS] = { 0 };
+	uint64 Friendly[MAX_FACTIONS] = { 0 };
+
+	FFactionMembers Members[(int32) EPlaygroundFaction::COUNT];
+	TMap<TWeakObjectPtr<UFactionComponent>, FMember> Registered;
+
+public:
+	UPROPERTY(Config, EditAnywhere, Category = "Factions")
+	TArray<FFactionRelation> Relations;
+
+	/** Edge length of a member grid cell. Around the typical hostile query radius works best. **/
+	UPROPERTY(Config, EditAnywhere, Category = "Factions")
+	float CellSize = 1000.0f;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Sets the relation between two factions, both ways. **/
+	UFUNCTION(BlueprintCallable, Category = "Factions")
+	void SetResponse(EPlaygroundFaction A, EPlaygroundFaction B, EFactionResponse Response);
+
+	UFUNCTION(BlueprintPure, Category = "Factions")
+	EFactionResponse GetResponse(EPlaygroundFaction A, EPlaygroundFaction B) const;
+
+	/** Relation between the factions of two actors, neutral if either has no UFactionComponent. **/
+	UFUNCTION(BlueprintPure, Category = "Factions")
+	EFactionResponse GetActorResponse(const AActor* A, const AActor* B) const;
+
+	UFUNCTION(BlueprintPure, Category = "Factions")
+	bool IsActorHostile(const AActor* A, const AActor* B) const {
+		return this->GetActorResponse(A, B) == EFactionResponse::HOSTILE;
+	}
+
+	/** Appends every actor hostile to Faction within Radius of Location to Out. **/
+	void GetHostileActorsNear(EPlaygroundFaction Faction, const FVector& Location, float Radius, TArray<AActor*>& Out) const;
+
+	/** Every actor hostile to Observer within Radius of Location. **/
+	UFUNCTION(BlueprintCallable, Category = "Factions")
+	TArray<AActor*> GetHostileActors(const AActor* Observer, FVector Location, float Radius) const;
+
+	/** Closest actor hostile to Observer within Radius of it, or null. **/
+	UFUNCTION(BlueprintCallable, Category = "Factions")
+	AActor* FindNearestHostile(const AActor* Observer, float Radius) const;
+
+	/** Adds the component's owner to the member grid of its faction. **/
+	void Register(UFactionComponent* Component);
+	void Unregister(UFactionComponent* Component);
+
+	FORCEINLINE bool IsHostile(EPlaygroundFaction A, EPlaygroundFaction B) const {
+		return (this->Hostile[(int32) A] >> (int32) B) & 1;
+	}
+
+	FORCEINLINE uint64 GetHostileMask(EPlaygroundFaction Faction) const { return this->Hostile[(int32) Faction]; }
+
+private:
+	void OnTransformUpdated(USceneComponent* Component, EUpdateTransformFlags Flags, ETeleportType Teleport,
+		EPlaygroundFaction Faction, int32 Id);
+};
@@ -3,3 +3,25 @@
 
 #include "FlagSet.h"
 
+FFlagSet UFlagSet::Add(const FFlagSet& Set, uint8 Flag) {
+	FFlagSet Result = Set;
+	if (Flag < FFlagSet::CAPACITY) {
+		Result.Add(Flag);
+	}
+	return Result;
+}
+
+FFlagSet UFlagSet::Remove(const FFlagSet& Set, uint8 Flag) {
+	FFlagSet Result = Set;
+	if (Flag < FFlagSet::CAPACITY) {
+		Result.Remove(Flag);
+	}
+	return Result;
+}
+
+TArray<uint8> UFlagSet::ToArray(const FFlagSet& Set) {
+	TArray<uint8> Result;
+	Result.Reserve(Set.Num());
+	Set.ForEach([&Result](uint8 Index) { Result.Add(Index); });
+	return Result;
+}
@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrassBenchmarkCommandlet.h"
+#include "GrassTileGenerator.h"
+#include "Async/ParallelFor.h"
+
+namespace GrassBenchmark {
+
+	static FGrassTileInput MakeInput(const FIntPoint& Tile, int32 Density, int32 Resolution, float Weight) {
+		FGrassTileInput Input;
+		Input.Tile = Tile;
+		Input.TileSize = 2000.0f;
+		Input.Resolution = Resolution;
+		Input.Density = Density;
+		Input.Seed = GrassTileGenerator::TileSeed(0, Tile);
+		Input.Fill(100.0f, Weight);
+		return Input;
+	}
+
+	/* Checks the blade count of a constant weight tile is within 5 standard deviations of expected. */
+	static bool CheckCount(const TCHAR* Name, int32 Density, int32 Resolution, float Weight) {
+		TArray<FGrassBlade> Blades;
+		const int32 Count = GrassTileGenerator::Generate(MakeInput(FIntPoint(3, -2), Density, Resolution, Weight), Blades);
+
+		const float Expected = Density * Weight;
+		const float Tolerance = 5.0f * FMath::Sqrt(Density * Weight * (1.0f - Weight));
+		const bool bPassed = FMath::Abs(Count - Expected) <= Tolerance;
+
+		UE_LOG(LogTemp, Display, TEXT("GrassBenchmark: %s weight %.2f, %d blades, expected %.0f +- %.0f %s"),
+			Name, Weight, Count, Expected, Tolerance, bPassed ? TEXT("ok") : TEXT("FAILED"));
+		return bPassed;
+	}
+
+	static bool CheckDeterminism(int32 Density, int32 Resolution) {
+		const FGrassTileInput Input = MakeInput(FIntPoint(-7, 11), Density, Resolution, 0.6f);
+		TArray<FGrassBlade> First, Second;
+		GrassTileGenerator::Generate(Input, First);
+		GrassTileGenerator::Generate(Input, Second);
+
+		// Compared bit for bit so every field, control points included, has to match exactly.
+		static_assert(sizeof(FGrassBlade) == 10 * sizeof(float), "FGrassBlade has padding, compare it field by field.");
+		const bool bPassed = First.Num() == Second.Num()
+			&& FMemory::Memcmp(First.GetData(), Second.GetData(), First.Num() * sizeof(FGrassBlade)) == 0;
+
+		UE_LOG(LogTemp, Display, TEXT("GrassBenchmark: determinism %s"), bPassed ? TEXT("ok") : TEXT("FAILED"));
+		return bPassed;
+	}
+}
+
+UGrassBenchmarkCommandlet::UGrassBenchmarkCommandlet() {
+	this->IsClient = false;
+	this->IsEditor = false;
+	this->IsServer = false;
+	this->LogToConsole = true;
+}
+
+int32 UGrassBenchmarkCommandlet::Main(const FString& Params) {
+	using namespace GrassBenchmark;
+
+	int32 TileCount = 256;
+	int32 Density = 4000;
+	int32 Resolution = 9;
+
+	FParse::Value(*Params, TEXT("Tiles="), TileCount);
+	FParse::Value(*Params, TEXT("Density="), Density);
+	FParse::Value(*Params, TEXT("Resolution="), Resolution);
+	TileCount = FMath::Max(1, TileCount);
+	Resolution = FMath::Max(2, Resolution);
+
+	bool bPassed = true;
+	bPassed &= CheckCount(TEXT("Empty"), Density, Resolution, 0.0f);
+	bPassed &= CheckCount(TEXT("Half"), Density, Resolution, 0.5f);
+	bPassed &= CheckCount(TEXT("Full"), Density, Resolution, 1.0f);
+	bPassed &= CheckDeterminism(Density, Resolution);
+
+	// Square block of tiles around the origin, like a streaming ring would request.
+	const int32 Side = FMath::CeilToInt(FMath::Sqrt((float) TileCount));
+	TArray<FGrassTileInput> Inputs;
+	for (int32 i = 0; i < TileCount; ++i) {
+		Inputs.Add(MakeInput(FIntPoint(i % Side, i / Side), Density, Resolution, 0.75f));
+	}
+
+	TArray<TArray<FGrassBlade>> Results;
+	Results.SetNum(TileCount);
+
+	double Start = FPlatformTime::Seconds();
+	GrassTileGenerator::Generate(Inputs[0], Results[0]);
+	const double SingleTime = FPlatformTime::Seconds() - Start;
+	Results[0].Reset();
+
+	Start = FPlatformTime::Seconds();
+	ParallelFor(TileCount, [&Inputs, &Results](int32 i) {
+		Results[i].Reserve(Inputs[i].Density);
+		GrassTileGenerator::Generate(Inputs[i], Results[i]);
+	});
+	const double ParallelTime = FPlatformTime::Seconds() - Start;
+
+	int64 Blades = 0;
+	for (const auto& Result : Results) {
+		Blades += Result.Num();
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("GrassBenchmark: %d tiles, %lld blades, single tile %.3f ms, all tiles %.2f ms (%.1f M blades/s)"),
+		TileCount, Blades, SingleTime * 1000.0, ParallelTime * 1000.0, Blades / FMath::Max(ParallelTime, 1e-9) / 1e6);
+
+	return bPassed ? 0 : 1;
+}
@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "GrassBenchmarkCommandlet.generated.h"
+
+/**
+ * Headless check of GrassTileGenerator. Generates tiles from synthetic inputs in parallel, checks blade
+ * counts against the layer weights, checks regenerating a tile gives the same blades, and reports
+ * timings. Returns non zero if a check fails.
+ *
+ * UnrealEditor-Cmd Playground.uproject -run=GrassBenchmark -nullrhi -unattended
+ *     [-Tiles=256] [-Density=4000] [-Resolution=9]
+ */
+UCLASS()
+class UGrassBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UGrassBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
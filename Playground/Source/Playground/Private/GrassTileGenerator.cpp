@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrassTileGenerator.h"
+
+void FGrassTileInput::Fill(float Height, float Weight) {
+	const int32 Count = this->Resolution * this->Resolution;
+	this->Heights.Init(Height, Count);
+	this->Weights.Init(Weight, Count);
+}
+
+namespace GrassTileGenerator {
+
+	/* Bilinear sample of a tile grid at a position in 0-1 tile space. */
+	static float Sample(const TArray<float>& Grid, int32 Resolution, float U, float V) {
+		const float X = U * (Resolution - 1);
+		const float Y = V * (Resolution - 1);
+		const int32 X0 = FMath::Clamp(FMath::FloorToInt(X), 0, Resolution - 2);
+		const int32 Y0 = FMath::Clamp(FMath::FloorToInt(Y), 0, Resolution - 2);
+		const float FX = X - X0;
+		const float FY = Y - Y0;
+
+		const float A = Grid[Y0 * Resolution + X0];
+		const float B = Grid[Y0 * Resolution + X0 + 1];
+		const float C = Grid[(Y0 + 1) * Resolution + X0];
+		const float D = Grid[(Y0 + 1) * Resolution + X0 + 1];
+
+		return FMath::Lerp(FMath::Lerp(A, B, FX), FMath::Lerp(C, D, FX), FY);
+	}
+
+	int32 TileSeed(int32 WorldSeed, const FIntPoint& Tile) {
+		return (int32) HashCombine(GetTypeHash(WorldSeed), GetTypeHash(Tile));
+	}
+
+	int32 Generate(const FGrassTileInput& Input, TArray<FGrassBlade>& Out) {
+		if (Input.Resolution < 2 || Input.Heights.Num() != Input.Resolution * Input.Resolution
+			|| Input.Weights.Num() != Input.Heights.Num())
+		{
+			return 0;
+		}
+
+		FRandomStream Random(Input.Seed);
+		const FVector2D Origin = Input.GetOrigin();
+		const int32 First = Out.Num();
+
+		for (int32 i = 0; i < Input.Density; ++i) {
+			// Draw every value up front so rejected candidates consume the stream identically.
+			const float U = Random.GetFraction();
+			const float V = Random.GetFraction();
+			const float Keep = Random.GetFraction();
+			const float Facing = Random.FRandRange(-PI, PI);
+			const float HeightAlpha = Random.GetFraction();
+			const float Stiffness = Random.FRandRange(Input.MinStiffness, Input.MaxStiffness);
+			const float Lean = Random.FRandRange(0.1f, 0.4f);
+
+			if (Keep >= Sample(Input.Weights, Input.Resolution, U, V)) {
+				continue;
+			}
+
+			FGrassBlade& Blade = Out.AddDefaulted_GetRef();
+			Blade.Position = FVector3f(
+				Origin.X + U * Input.TileSize,
+				Origin.Y + V * Input.TileSize,
+				Sample(Input.Heights, Input.Resolution, U, V));
+			Blade.Facing = Facing;
+			Blade.Height = FMath::Lerp(Input.MinHeight, Input.MaxHeight, HeightAlpha);
+			Blade.Stiffness = Stiffness;
+
+			// Softer blades lean further forward at the tip.
+			const float Bend = Lean * (1.0f - Stiffness);
+			Blade.Control1 = FVector2f(Bend * 0.25f, 0.5f);
+			Blade.Control2 = FVector2f(Bend, 1.0f - Bend * 0.5f);
+		}
+
+		return Out.Num() - First;
+	}
+}
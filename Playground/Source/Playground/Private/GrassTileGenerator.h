@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Per blade instance data of the procedural grass. Position and facing go into the instance transform,
+ * the rest into per instance custom data read by M_ProceduralGrass, in the order of this struct after
+ * Facing: Height, Stiffness, Control1 (forward, up), Control2 (forward, up).
+ */
+struct FGrassBlade
+{
+	FVector3f Position;
+	float Facing;
+	float Height;
+	float Stiffness;
+	// Bezier control points in the blade's plane, relative to its root and scaled by Height.
+	FVector2f Control1;
+	FVector2f Control2;
+
+	static constexpr int32 CUSTOM_DATA_FLOATS = 6;
+};
+
+/**
+ * Everything needed to generate one tile without touching the landscape, snapshotted on the game
+ * thread. Heights and layer weights are sampled on a (Resolution x Resolution) grid over the tile.
+ */
+struct FGrassTileInput
+{
+	FIntPoint Tile = FIntPoint::ZeroValue;
+	float TileSize = 0.0f;
+	int32 Resolution = 0;
+	TArray<float> Heights;
+	TArray<float> Weights;
+
+	/** Candidate blades; each is kept with a probability equal to the layer weight under it. **/
+	int32 Density = 0;
+	int32 Seed = 0;
+
+	float MinHeight = 40.0f;
+	float MaxHeight = 80.0f;
+	float MinStiffness = 0.2f;
+	float MaxStiffness = 0.8f;
+
+	FORCEINLINE FVector2D GetOrigin() const { return FVector2D(this->Tile) * this->TileSize; }
+
+	/** Fills the grids with a constant height and weight, for tests. **/
+	void Fill(float Height, float Weight);
+};
+
+namespace GrassTileGenerator {
+
+	/**
+	 * Generates the blades of a tile. Deterministic for a given input, and safe to call from any thread.
+	 * Returns the number of blades appended to Out.
+	 */
+	int32 Generate(const FGrassTileInput& Input, TArray<FGrassBlade>& Out);
+
+	/** Seed of a tile, mixed from the world seed so neighbouring tiles don't repeat. **/
+	int32 TileSeed(int32 WorldSeed, const FIntPoint& Tile);
+}
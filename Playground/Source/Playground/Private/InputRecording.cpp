@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InputRecording.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+
+static const uint32 RECORDING_VERSION = 2;
+// Packed frame delta, action, value type and one float.
+static const int64 MIN_RECORD_BYTES = 7;
+static const uint8 RECORDING_MAGIC[4] = { 'P', 'G', 'I', 'R' };
+
+bool FInputRecording::Save(const FString& Path) const {
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+
+	Writer.Serialize((void*) RECORDING_MAGIC, 4);
+	uint32 Version = RECORDING_VERSION;
+	uint32 Count = this->Records.Num();
+	Writer << Version << Count;
+
+	uint32 Previous = 0;
+	for (const FInputRecord& r : this->Records) {
+		uint32 Delta = r.Frame - Previous;
+		uint8 Action = (uint8) r.Action;
+		uint8 Type = (uint8) r.Value.GetValueType();
+		FVector Axis = r.Value.Get<FVector>();
+
+		Writer.SerializeIntPacked(Delta);
+		Writer << Action << Type;
+
+		// Booleans are stored as a single axis, like FInputActionValue does internally.
+		const int32 Floats = FMath::Max(1, (int32) Type);
+		for (int32 i = 0; i < Floats; ++i) {
+			float Component = (float) Axis[i];
+			Writer << Component;
+		}
+
+		Previous = r.Frame;
+	}
+
+	uint32 Frames = this->Deltas.Num();
+	Writer << Frames;
+	for (float Delta : this->Deltas) {
+		Writer << Delta;
+	}
+
+	return FFileHelper::SaveArrayToFile(Bytes, *Path);
+}
+
+bool FInputRecording::Load(const FString& Path) {
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path)) {
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes);
+	uint8 Magic[4];
+	uint32 Version = 0;
+	uint32 Count = 0;
+
+	Reader.Serialize(Magic, 4);
+	Reader << Version << Count;
+	if (FMemory::Memcmp(Magic, RECORDING_MAGIC, 4) != 0 || Version != RECORDING_VERSION) {
+		return false;
+	}
+
+	// Don't trust the count with an allocation the file couldn't fill.
+	if (Reader.IsError() || Count > (Reader.TotalSize() - Reader.Tell()) / MIN_RECORD_BYTES) {
+		return false;
+	}
+
+	this->Records.Reset(Count);
+	uint32 Frame = 0;
+	for (uint32 n = 0; n < Count && !Reader.IsError(); ++n) {
+		uint32 Delta = 0;
+		uint8 Action = 0;
+		uint8 Type = 0;
+
+		Reader.SerializeIntPacked(Delta);
+		Reader << Action << Type;
+
+		FVector Axis = FVector::ZeroVector;
+		const int32 Floats = FMath::Max(1, (int32) Type);
+		for (int32 i = 0; i < Floats && i < 3; ++i) {
+			float Component = 0.0f;
+			Reader << Component;
+			Axis[i] = Component;
+		}
+
+		Frame += Delta;
+		this->Add(Frame, (EInputRecordAction) Action, FInputActionValue((EInputActionValueType) Type, Axis));
+	}
+
+	uint32 Frames = 0;
+	Reader << Frames;
+	if (Reader.IsError() || Frames > (Reader.TotalSize() - Reader.Tell()) / sizeof(float)) {
+		return false;
+	}
+
+	this->Deltas.SetNumUninitialized(Frames);
+	for (float& Delta : this->Deltas) {
+		Reader << Delta;
+	}
+
+	return !Reader.IsError();
+}
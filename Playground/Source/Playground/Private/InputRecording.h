@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InputActionValue.h"
+
+/**
+ * Input handlers of APlaygroundCharacter that can be recorded and replayed.
+ */
+enum class EInputRecordAction : uint8 {
+	JUMP,
+	STOP_JUMP,
+	MOVE,
+	STOP_MOVE,
+	RUN,
+	STOP_RUN,
+	LOOK,
+	SPELLCAST,
+	ATTACK,
+	GUARD,
+	GUARD_RELEASE,
+};
+
+/**
+ * A single input event, stamped with the frame it arrived on relative to the start of recording.
+ */
+struct FInputRecord
+{
+	uint32 Frame;
+	EInputRecordAction Action;
+	FInputActionValue Value;
+};
+
+/**
+ * Recorded stream of character input. Saved as "PGIR", uint32 version, uint32 count, then per record the
+ * frame delta from the previous record (packed int), the action, the value type and only as many floats
+ * as that value type uses. Followed by uint32 frame count and the world delta time of every frame, so a
+ * replay can tick with the same steps as the session.
+ */
+class FInputRecording
+{
+public:
+	TArray<FInputRecord> Records;
+	// World delta time of each frame since recording started, indexed by frame.
+	TArray<float> Deltas;
+
+	FORCEINLINE void Add(uint32 Frame, EInputRecordAction Action, const FInputActionValue& Value) {
+		this->Records.Add({ Frame, Action, Value });
+	}
+
+	FORCEINLINE void SetDelta(uint32 Frame, float DeltaTime) {
+		if ((int32) Frame >= this->Deltas.Num()) {
+			this->Deltas.SetNumZeroed(Frame + 1);
+		}
+		this->Deltas[Frame] = DeltaTime;
+	}
+
+	/* Recorded delta time of Frame, or Default for frames recorded without one. */
+	FORCEINLINE float GetDelta(uint32 Frame, float Default) const {
+		return this->Deltas.IsValidIndex(Frame) && this->Deltas[Frame] > 0.0f ? this->Deltas[Frame] : Default;
+	}
+
+	FORCEINLINE uint32 LastFrame() const { return this->Records.Num() > 0 ? this->Records.Last().Frame : 0; }
+
+	bool Save(const FString& Path) const;
+	bool Load(const FString& Path);
+};
@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InputReplayCommandlet.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "PlaygroundCharacter.h"
+
+UInputReplayCommandlet::UInputReplayCommandlet() {
+	this->IsClient = false;
+	this->IsEditor = false;
+	this->IsServer = false;
+	this->LogToConsole = true;
+}
+
+int32 UInputReplayCommandlet::Main(const FString& Params) {
+	FString File;
+	FString Map;
+	float Dt = 1.0f / 60.0f;
+
+	if (!FParse::Value(*Params, TEXT("File="), File)) {
+		UE_LOG(LogTemp, Error, TEXT("InputReplay: -File= is required."));
+		return 1;
+	}
+	FParse::Value(*Params, TEXT("Map="), Map);
+	// Recorded frame times are replayed unless a fixed step is forced.
+	const bool bFixedDt = FParse::Value(*Params, TEXT("Dt="), Dt);
+
+	UWorld* World = nullptr;
+	if (!Map.IsEmpty()) {
+		if (UPackage* Package = LoadPackage(nullptr, *Map, LOAD_None)) {
+			World = UWorld::FindWorldInPackage(Package);
+		}
+		if (World == nullptr) {
+			UE_LOG(LogTemp, Error, TEXT("InputReplay: Could not load map %s."), *Map);
+			return 1;
+		}
+		World->WorldType = EWorldType::Game;
+		World->InitWorld();
+	} else {
+		World = UWorld::CreateWorld(EWorldType::Game, false);
+	}
+
+	FWorldContext& Context = GEngine->CreateNewWorldContext(EWorldType::Game);
+	Context.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	APlaygroundCharacter* Character = World->SpawnActor<APlaygroundCharacter>(
+		APlaygroundCharacter::StaticClass(), FTransform::Identity, SpawnParams);
+
+	int32 Result = 1;
+	if (Character == nullptr) {
+		UE_LOG(LogTemp, Error, TEXT("InputReplay: Could not spawn a PlaygroundCharacter."));
+	} else if (!Character->StartInputReplay(File)) {
+		UE_LOG(LogTemp, Error, TEXT("InputReplay: Could not load recording %s."), *File);
+	} else {
+		// There is no controller headlessly, movement input would otherwise be ignored.
+		Character->GetCharacterMovement()->bRunPhysicsWithNoController = true;
+
+		int32 Frames = 0;
+		double Simulated = 0.0;
+		const double Start = FPlatformTime::Seconds();
+		while (Character->IsReplayingInput()) {
+			const float FrameDt = bFixedDt ? Dt : Character->GetReplayDeltaTime(Dt);
+			World->Tick(LEVELTICK_All, FrameDt);
+			Simulated += FrameDt;
+			Frames += 1;
+		}
+		const double Seconds = FPlatformTime::Seconds() - Start;
+
+		UE_LOG(LogTemp, Display, TEXT("InputReplay: %d frames in %.3fs (%.1f fps, %.1fx real time). Final location %s, state %s."),
+			Frames, Seconds, Frames / FMath::Max(Seconds, 1e-6), Simulated / FMath::Max(Seconds, 1e-6),
+			*Character->GetActorLocation().ToString(),
+			*UEnum::GetValueAsString((EPlaygroundCharacterState) Character->GetMachine()->CurrentState->ID));
+		Result = 0;
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	return Result;
+}
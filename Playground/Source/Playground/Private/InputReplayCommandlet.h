@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "InputReplayCommandlet.generated.h"
+
+/**
+ * Replays an input recording into a character headlessly, ticking the world with the recorded frame
+ * times (or a fixed -Dt= step) as fast as possible. Reports frames per second so it doubles as a
+ * throughput benchmark.
+ *
+ * UnrealEditor-Cmd Playground.uproject -run=InputReplay -nullrhi -unattended -File=Recording.pgir
+ *     [-Map=/Game/Assets/Levels/Testing] [-Dt=0.016667]
+ */
+UCLASS()
+class UInputReplayCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UInputReplayCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
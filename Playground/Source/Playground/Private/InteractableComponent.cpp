@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InteractableComponent.h"
+#include "InteractionSubsystem.h"
+#include "Engine/World.h"
+
+void UInteractableComponent::SetInteractionEnabled(bool bEnabled) {
+	if (this->bInteractionEnabled == bEnabled) {
+		return;
+	}
+
+	this->bInteractionEnabled = bEnabled;
+	if (!this->HasBegunPlay()) {
+		return;
+	}
+
+	// Re-registering sends the leaves, and lets the next update send enters again.
+	if (auto Interaction = UWorld::GetSubsystem<UInteractionSubsystem>(this->GetWorld())) {
+		if (bEnabled) {
+			Interaction->Register(this);
+		} else {
+			Interaction->Unregister(this);
+		}
+	}
+}
+
+void UInteractableComponent::BeginPlay() {
+	Super::BeginPlay();
+
+	if (!this->bInteractionEnabled) {
+		return;
+	}
+
+	if (auto Interaction = UWorld::GetSubsystem<UInteractionSubsystem>(this->GetWorld())) {
+		Interaction->Register(this);
+	}
+}
+
+void UInteractableComponent::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	if (auto Interaction = UWorld::GetSubsystem<UInteractionSubsystem>(this->GetWorld())) {
+		Interaction->Unregister(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "InteractableComponent.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FInteractionEvent, AActor*, Interactor);
+
+UENUM(BlueprintType)
+enum class EInteractionKind : uint8 {
+	/** Levers and pickups, used with the interact input by the player it is the best candidate of. **/
+	ACTIVATE,
+	/** Pressure plates and popup colliders, notified of every interactor in range. **/
+	PROXIMITY,
+};
+
+/**
+ * Registers its owner with UInteractionSubsystem, which replaces the owner's own overlap bookkeeping.
+ * Events are sent through the owner's existing Blueprint interfaces (BPI_Activator, BPI_Displayable)
+ * and broadcast on the delegates below.
+ */
+UCLASS(ClassGroup=(Playground), meta=(BlueprintSpawnableComponent))
+class UInteractableComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction")
+	EInteractionKind Kind = EInteractionKind::ACTIVATE;
+
+	/** Distance from the owner's location at which interactors enter. **/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction")
+	float Radius = 200.0f;
+
+	/** Added to the candidate score, so e.g. pickups win over a lever behind them. **/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction")
+	float Priority = 0.0f;
+
+	UPROPERTY(BlueprintAssignable, Category = "Interaction")
+	FInteractionEvent OnInteractorEnter;
+
+	UPROPERTY(BlueprintAssignable, Category = "Interaction")
+	FInteractionEvent OnInteractorLeave;
+
+	UPROPERTY(BlueprintAssignable, Category = "Interaction")
+	FInteractionEvent OnActivated;
+
+	/** Disabled interactables leave every interactor and can't be candidates. **/
+	UFUNCTION(BlueprintCallable, Category = "Interaction")
+	void SetInteractionEnabled(bool bEnabled);
+
+	FORCEINLINE bool IsInteractionEnabled() const { return this->bInteractionEnabled; }
+
+protected:
+	UPROPERTY(EditAnywhere, Category = "Interaction")
+	bool bInteractionEnabled = true;
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+};
@@ -0,0 +1,346 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InteractionSubsystem.h"
+#include "InteractableComponent.h"
+#include "Components/SceneComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Algo/BinarySearch.h"
+#include "PlaygroundStatics.h"
+
+DECLARE_STATS_GROUP(TEXT("Interaction"), STATGROUP_Interaction, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Update"), STAT_InteractionUpdate, STATGROUP_Interaction);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Events"), STAT_InteractionEvents, STATGROUP_Interaction);
+
+void UInteractionSubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+	Super::Initialize(Collection);
+	this->Grid.Reset(this->CellSize);
+}
+
+void UInteractionSubsystem::Deinitialize() {
+	for (const FInteractable& Interactable : this->Interactables) {
+		if (Interactable.Component.IsValid() && Interactable.Component->GetOwner()->GetRootComponent()) {
+			Interactable.Component->GetOwner()->GetRootComponent()->TransformUpdated.Remove(Interactable.Handle);
+		}
+	}
+
+	this->Interactables.Reset();
+	this->Ids.Reset();
+	this->Interactors.Reset();
+	this->Grid.Reset(this->CellSize);
+	Super::Deinitialize();
+}
+
+void UInteractionSubsystem::Register(UInteractableComponent* Component) {
+	if (Component == nullptr || Component->GetOwner() == nullptr || this->Ids.Contains(Component)) {
+		return;
+	}
+
+	AActor* Owner = Component->GetOwner();
+	const int32 Id = this->Grid.Add(Owner->GetActorLocation());
+	if (!this->Interactables.IsValidIndex(Id)) {
+		this->Interactables.SetNum(Id + 1);
+	}
+
+	FInteractable& Interactable = this->Interactables[Id];
+	Interactable.Component = Component;
+	if (USceneComponent* Root = Owner->GetRootComponent()) {
+		Interactable.Handle = Root->TransformUpdated.AddUObject(this, &UInteractionSubsystem::OnTransformUpdated, Id);
+	}
+
+	this->Ids.Add(Component, Id);
+	this->MaxRadius = FMath::Max(this->MaxRadius, Component->Radius);
+	++this->Revision;
+}
+
+void UInteractionSubsystem::Unregister(UInteractableComponent* Component) {
+	int32 Id;
+	if (!this->Ids.RemoveAndCopyValue(Component, Id)) {
+		return;
+	}
+
+	// Leave before the id is freed, while the component can still be notified.
+	for (FInteractor& Interactor : this->Interactors) {
+		if (Interactor.Best == Id) {
+			this->SetBest(Interactor, INDEX_NONE);
+		}
+
+		const int32 Index = Algo::BinarySearch(Interactor.Overlaps, Id);
+		if (Index != INDEX_NONE) {
+			Interactor.Overlaps.RemoveAt(Index);
+			if (this->IsProximity(Id)) {
+				this->Leave(Id, Interactor.Actor.Get());
+			}
+		}
+	}
+
+	FInteractable& Interactable = this->Interactables[Id];
+	if (Component->GetOwner() && Component->GetOwner()->GetRootComponent()) {
+		Component->GetOwner()->GetRootComponent()->TransformUpdated.Remove(Interactable.Handle);
+	}
+
+	Interactable = FInteractable();
+	this->Grid.Remove(Id);
+	++this->Revision;
+}
+
+void UInteractionSubsystem::OnTransformUpdated(USceneComponent* Component, EUpdateTransformFlags Flags,
+	ETeleportType Teleport, int32 Id)
+{
+	this->Grid.Move(Id, Component->GetComponentLocation());
+	++this->Revision;
+}
+
+bool UInteractionSubsystem::IsProximity(int32 Id) const {
+	const UInteractableComponent* Component = this->Interactables[Id].Component.Get();
+	return Component && Component->Kind == EInteractionKind::PROXIMITY;
+}
+
+void UInteractionSubsystem::SyncInteractors() {
+	TArray<AActor*, TInlineAllocator<4>> Pawns;
+	for (auto It = this->GetWorld()->GetPlayerControllerIterator(); It; ++It) {
+		if (APlayerController* Controller = It->Get()) {
+			if (APawn* Pawn = Controller->GetPawn()) {
+				Pawns.Add(Pawn);
+			}
+		}
+	}
+
+	// Pawns that were unpossessed leave everything; destroyed ones can't be told.
+	for (int32 i = this->Interactors.Num() - 1; i >= 0; --i) {
+		FInteractor& Interactor = this->Interactors[i];
+		AActor* Actor = Interactor.Actor.Get();
+
+		if (Actor && Pawns.Contains(Actor)) {
+			Pawns.Remove(Actor);
+			continue;
+		}
+
+		if (Actor) {
+			this->SetBest(Interactor, INDEX_NONE);
+			for (int32 Id : Interactor.Overlaps) {
+				if (this->IsProximity(Id)) {
+					this->Leave(Id, Actor);
+				}
+			}
+		}
+
+		this->Interactors.RemoveAtSwap(i);
+	}
+
+	for (AActor* Pawn : Pawns) {
+		FInteractor& Interactor = this->Interactors.AddDefaulted_GetRef();
+		Interactor.Actor = Pawn;
+	}
+}
+
+void UInteractionSubsystem::Tick(float DeltaTime) {
+	SCOPE_CYCLE_COUNTER(STAT_InteractionUpdate);
+
+	this->SyncInteractors();
+
+	for (FInteractor& Interactor : this->Interactors) {
+		// Destroyed pawns are dropped by the next sync.
+		if (Interactor.Actor.IsValid()) {
+			this->Update(Interactor);
+		}
+	}
+}
+
+void UInteractionSubsystem::Update(FInteractor& Interactor) {
+	AActor* Actor = Interactor.Actor.Get();
+	const FVector Location = Actor->GetActorLocation();
+	++this->Stats.Updates;
+
+	if (Interactor.Revision == this->Revision && Interactor.Location.Equals(Location, 1.0f)) {
+		// Only facing can have changed.
+		++this->Stats.CachedUpdates;
+		this->SetBest(Interactor, this->PickBest(Interactor));
+		return;
+	}
+
+	Interactor.Location = Location;
+	Interactor.Revision = this->Revision;
+
+	TArray<int32> Found;
+	this->Grid.QueryRadius(Location, this->MaxRadius, Found);
+
+	Found.RemoveAllSwap([this, &Location](int32 Id) {
+		const UInteractableComponent* Component = this->Interactables[Id].Component.Get();
+		return Component == nullptr
+			|| FVector::DistSquared(this->Grid.GetLocation(Id), Location) > FMath::Square(Component->Radius);
+	});
+	Found.Sort();
+
+	// Swapped in before any event is sent, in case one unregisters an interactable.
+	const TArray<int32> Previous = MoveTemp(Interactor.Overlaps);
+	Interactor.Overlaps = Found;
+
+	// Merge the sorted sets, sending only the differences.
+	int32 i = 0;
+	int32 j = 0;
+	while (i < Previous.Num() || j < Found.Num()) {
+		if (j >= Found.Num() || (i < Previous.Num() && Previous[i] < Found[j])) {
+			if (this->IsProximity(Previous[i])) {
+				this->Leave(Previous[i], Actor);
+			}
+			++i;
+		} else if (i >= Previous.Num() || Found[j] < Previous[i]) {
+			if (this->IsProximity(Found[j])) {
+				this->Enter(Found[j], Actor);
+			}
+			++j;
+		} else {
+			++i;
+			++j;
+		}
+	}
+
+	// An event may have destroyed the interactor, which can't be told and is dropped by the next sync.
+	if (!Interactor.Actor.IsValid()) {
+		return;
+	}
+
+	this->SetBest(Interactor, this->PickBest(Interactor));
+}
+
+int32 UInteractionSubsystem::PickBest(const FInteractor& Interactor) const {
+	const AActor* Actor = Interactor.Actor.Get();
+	if (Actor == nullptr) {
+		return INDEX_NONE;
+	}
+
+	const APawn* Pawn = Cast<APawn>(Actor);
+	const FVector Facing = (Pawn ? Pawn->GetControlRotation().Vector() : Actor->GetActorForwardVector()).GetSafeNormal2D();
+
+	int32 Best = INDEX_NONE;
+	float BestScore = MAX_flt;
+
+	for (int32 Id : Interactor.Overlaps) {
+		const UInteractableComponent* Component = this->Interactables[Id].Component.Get();
+		if (Component == nullptr || Component->Kind != EInteractionKind::ACTIVATE) {
+			continue;
+		}
+
+		// 0 on top of it, 1 at the edge, less when looking at it.
+		const FVector Offset = this->Grid.GetLocation(Id) - Interactor.Location;
+		const float Distance = Offset.Size() / FMath::Max(Component->Radius, 1.0f);
+		const float Score = Distance - this->FacingWeight * (Facing | Offset.GetSafeNormal2D()) - Component->Priority;
+
+		if (Score < BestScore) {
+			BestScore = Score;
+			Best = Id;
+		}
+	}
+
+	return Best;
+}
+
+void UInteractionSubsystem::SetBest(FInteractor& Interactor, int32 Best) {
+	if (Interactor.Best == Best) {
+		return;
+	}
+
+	if (Interactor.Best != INDEX_NONE) {
+		this->Leave(Interactor.Best, Interactor.Actor.Get());
+	}
+
+	Interactor.Best = Best;
+
+	if (Best != INDEX_NONE) {
+		this->Enter(Best, Interactor.Actor.Get());
+	}
+}
+
+void UInteractionSubsystem::Enter(int32 Id, AActor* Interactor) {
+	UInteractableComponent* Component = this->Interactables[Id].Component.Get();
+	if (Component == nullptr) {
+		return;
+	}
+
+	++this->Stats.Enters;
+	INC_DWORD_STAT(STAT_InteractionEvents);
+
+	// Both are told to the pawn, passing the interactable.
+	const FName Function = Component->Kind == EInteractionKind::ACTIVATE ? this->DeclareFunction : this->ShowFunction;
+	UPlaygroundStatics::CallBlueprintFunction(Interactor, Function, Component->GetOwner());
+
+	Component->OnInteractorEnter.Broadcast(Interactor);
+}
+
+void UInteractionSubsystem::Leave(int32 Id, AActor* Interactor) {
+	UInteractableComponent* Component = this->Interactables[Id].Component.Get();
+	if (Component == nullptr) {
+		return;
+	}
+
+	++this->Stats.Leaves;
+	INC_DWORD_STAT(STAT_InteractionEvents);
+
+	const FName Function = Component->Kind == EInteractionKind::ACTIVATE ? this->RemoveFunction : this->HideFunction;
+	UPlaygroundStatics::CallBlueprintFunction(Interactor, Function, Component->GetOwner());
+
+	Component->OnInteractorLeave.Broadcast(Interactor);
+}
+
+bool UInteractionSubsystem::Interact(AActor* Interactor) {
+	const FInteractor* Found = this->Interactors.FindByPredicate([Interactor](const FInteractor& Entry) {
+		return Entry.Actor == Interactor;
+	});
+
+	if (Found == nullptr || Found->Best == INDEX_NONE) {
+		return false;
+	}
+
+	UInteractableComponent* Component = this->Interactables[Found->Best].Component.Get();
+	if (Component == nullptr) {
+		return false;
+	}
+
+	++this->Stats.Activations;
+	INC_DWORD_STAT(STAT_InteractionEvents);
+
+	UPlaygroundStatics::CallBlueprintFunction(Component->GetOwner(), this->InteractFunction, Interactor);
+	Component->OnActivated.Broadcast(Interactor);
+	return true;
+}
+
+AActor* UInteractionSubsystem::GetBestInteractable(AActor* Interactor) const {
+	const FInteractor* Found = this->Interactors.FindByPredicate([Interactor](const FInteractor& Entry) {
+		return Entry.Actor == Interactor;
+	});
+
+	if (Found == nullptr || Found->Best == INDEX_NONE) {
+		return nullptr;
+	}
+
+	const UInteractableComponent* Component = this->Interactables[Found->Best].Component.Get();
+	return Component ? Component->GetOwner() : nullptr;
+}
+
+TStatId UInteractionSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UInteractionSubsystem, STATGROUP_Tickables);
+}
+
+static FAutoConsoleCommandWithWorld GDumpInteractionCommand(
+	TEXT("Playground.DumpInteraction"),
+	TEXT("Logs interactables, interactors and how many interaction events were sent."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World) {
+		auto Subsystem = UWorld::GetSubsystem<UInteractionSubsystem>(World);
+		if (Subsystem == nullptr) {
+			return;
+		}
+
+		const FInteractionStats& Stats = Subsystem->GetStats();
+		UE_LOG(LogTemp, Log, TEXT("Interaction: %d interactables, %d interactors, %d updates (%d cached), %d enters, %d leaves, %d activations"),
+			Subsystem->Num(),
+			Subsystem->NumInteractors(),
+			Stats.Updates,
+			Stats.CachedUpdates,
+			Stats.Enters,
+			Stats.Leaves,
+			Stats.Activations);
+	}));
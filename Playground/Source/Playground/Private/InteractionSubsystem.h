@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TargetHashGrid.h"
+#include "InteractionSubsystem.generated.h"
+
+class UInteractableComponent;
+
+struct FInteractionStats {
+	int32 Updates = 0;
+	// Updates where neither the interactor nor any interactable moved, so the cached overlaps were kept.
+	int32 CachedUpdates = 0;
+	int32 Enters = 0;
+	int32 Leaves = 0;
+	int32 Activations = 0;
+};
+
+/**
+ * Single broadphase for levers, pressure plates, pickups and popup colliders (UInteractableComponent).
+ * Once per frame each player's pawn gets its overlap set, diffed against the previous frame, and its best
+ * candidate for the interact input. Only the differences are sent on, as enter and leave events:
+ *
+ *  - ACTIVATE interactables enter when they become a player's best candidate, which is declared to the
+ *    pawn through BPI_Interactor (Declare Interactable / Remove Interactable).
+ *  - PROXIMITY interactables enter for every pawn in range, which is told through BPI_DialogueActor
+ *    (Display Popup / Hide Popup) with the interactable, a BPI_Displayable, as the popup, like
+ *    BP_PopupTextCollider does.
+ *
+ * Interact sends BPI_Activator's Interact to the best candidate. The Blueprint functions are looked up by
+ * name, so actors that don't implement an interface only get the component's delegates.
+ */
+UCLASS(Config=Game)
+class UInteractionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	struct FInteractable {
+		TWeakObjectPtr<UInteractableComponent> Component;
+		FDelegateHandle Handle;
+	};
+
+	struct FInteractor {
+		TWeakObjectPtr<AActor> Actor;
+		// Sorted ids of the interactables in range.
+		TArray<int32> Overlaps;
+		int32 Best = INDEX_NONE;
+		FVector Location = FVector::ZeroVector;
+		uint32 Revision = 0;
+	};
+
+	FTargetHashGrid Grid;
+	// Indexed by grid id.
+	TArray<FInteractable> Interactables;
+	TMap<TWeakObjectPtr<UInteractableComponent>, int32> Ids;
+	TArray<FInteractor> Interactors;
+	// Largest registered radius, the broadphase query extent.
+	float MaxRadius = 0.0f;
+	// Bumped whenever an interactable is added, removed or moved, invalidating every cached overlap set.
+	uint32 Revision = 1;
+	FInteractionStats Stats;
+
+public:
+	UPROPERTY(Config, EditAnywhere, Category = "Interaction")
+	float CellSize = 1000.0f;
+
+	/** How much facing an interactable outweighs being near it when picking the best candidate. **/
+	UPROPERTY(Config, EditAnywhere, Category = "Interaction")
+	float FacingWeight = 0.5f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Interaction")
+	FName DeclareFunction = TEXT("Declare Interactable");
+
+	UPROPERTY(Config, EditAnywhere, Category = "Interaction")
+	FName RemoveFunction = TEXT("Remove Interactable");
+
+	UPROPERTY(Config, EditAnywhere, Category = "Interaction")
+	FName InteractFunction = TEXT("Interact");
+
+	UPROPERTY(Config, EditAnywhere, Category = "Interaction")
+	FName ShowFunction = TEXT("Display Popup");
+
+	UPROPERTY(Config, EditAnywhere, Category = "Interaction")
+	FName HideFunction = TEXT("Hide Popup");
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void Register(UInteractableComponent* Component);
+	void Unregister(UInteractableComponent* Component);
+
+	/** Activates Interactor's best candidate. Returns false if it has none. **/
+	UFUNCTION(BlueprintCallable, Category = "Interaction")
+	bool Interact(AActor* Interactor);
+
+	UFUNCTION(BlueprintPure, Category = "Interaction")
+	AActor* GetBestInteractable(AActor* Interactor) const;
+
+	FORCEINLINE const FInteractionStats& GetStats() const { return this->Stats; }
+	FORCEINLINE int32 Num() const { return this->Grid.Num(); }
+	FORCEINLINE int32 NumInteractors() const { return this->Interactors.Num(); }
+
+private:
+	void SyncInteractors();
+	void Update(FInteractor& Interactor);
+	int32 PickBest(const FInteractor& Interactor) const;
+	bool IsProximity(int32 Id) const;
+
+	void Enter(int32 Id, AActor* Interactor);
+	void Leave(int32 Id, AActor* Interactor);
+	void SetBest(FInteractor& Interactor, int32 Best);
+
+	void OnTransformUpdated(USceneComponent* Component, EUpdateTransformFlags Flags, ETeleportType Teleport, int32 Id);
+};
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+#include "PlaygroundCharacter.h"
+
+/**
+ * Micro-benchmark of the event dispatch of PlaygroundCharacterStateMachine: the virtual call on the
+ * current state plus UpdateState. Spawns a throwaway character in the current world and runs a fixed
+ * event sequence through it after a short warm up.
+ *
+ * Usage: Playground.BenchmarkDispatch [Iterations]
+ */
+static double RunDispatchSequence(PlaygroundCharacterStateMachine* Machine, int Iterations, int64& OutEvents) {
+	int64 Events = 0;
+	const double Start = FPlatformTime::Seconds();
+
+	#define BENCHMARK_EVENT(Call) Machine->Call; ++Events
+
+	for (int i = 0; i < Iterations; ++i) {
+		Machine->InputAxis = FVector2D(0.0f, 1.0f);
+		BENCHMARK_EVENT(AttemptMove());
+		BENCHMARK_EVENT(AttemptLook());
+		BENCHMARK_EVENT(AttemptMove());
+		Machine->RunPressed = true;
+		BENCHMARK_EVENT(RunUpdate());
+		BENCHMARK_EVENT(AttemptMove());
+		Machine->RunPressed = false;
+		BENCHMARK_EVENT(RunUpdate());
+		BENCHMARK_EVENT(StopMove());
+		BENCHMARK_EVENT(AttemptCast());
+		BENCHMARK_EVENT(AttemptMove());
+		BENCHMARK_EVENT(StopMove());
+		BENCHMARK_EVENT(FinishCast());
+		BENCHMARK_EVENT(AttemptAttack());
+		BENCHMARK_EVENT(AttemptLook());
+		BENCHMARK_EVENT(FinishAttack());
+	}
+
+	#undef BENCHMARK_EVENT
+
+	const double Elapsed = FPlatformTime::Seconds() - Start;
+	OutEvents = Events;
+	return Elapsed;
+}
+
+static void RunDispatchBenchmark(const TArray<FString>& Args, UWorld* World) {
+	if (World == nullptr) {
+		return;
+	}
+
+	int Iterations = 10000;
+	if (Args.Num() > 0) {
+		Iterations = FMath::Max(1, FCString::Atoi(*Args[0]));
+	}
+
+	FActorSpawnParameters Params;
+	Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	APlaygroundCharacter* Character = World->SpawnActor<APlaygroundCharacter>(
+		APlaygroundCharacter::StaticClass(), FTransform::Identity, Params);
+
+	if (Character == nullptr) {
+		UE_LOG(LogTemp, Warning, TEXT("BenchmarkDispatch: Could not spawn a PlaygroundCharacter."));
+		return;
+	}
+
+	auto Machine = Character->GetMachine();
+	int64 Events = 0;
+
+	RunDispatchSequence(Machine, FMath::Min(Iterations, 100), Events);
+	const double Time = RunDispatchSequence(Machine, Iterations, Events);
+
+	UE_LOG(LogTemp, Log, TEXT("BenchmarkDispatch: %d iterations, %lld events, %.2f ns/event"),
+		Iterations,
+		Events,
+		Time * 1e9 / FMath::Max<int64>(1, Events));
+
+	Character->Destroy();
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GBenchmarkDispatchCommand(
+	TEXT("Playground.BenchmarkDispatch"),
+	TEXT("Measures event dispatch of the character state machine. Args: [Iterations]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunDispatchBenchmark));
@@ -0,0 +1,229 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MachineBenchmarkCommandlet.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/MemoryBase.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/DateTime.h"
+
+typedef PlaygroundCharacterStateMachine Machine;
+
+namespace MachineBenchmark {
+
+	/* Accumulated measurements for one scenario. */
+	struct FResult {
+		FString Name;
+		uint64 Events = 0;
+		uint64 Transitions = 0;
+		// Cycles of the events that changed the state, the others only cost their no-op dispatch.
+		uint64 TransitionCycles = 0;
+		uint64 Allocations = 0;
+		double Seconds = 0.0;
+		TArray<uint64> EventCycles;
+	};
+
+	static uint64 AllocationCount() {
+		#if !UE_BUILD_SHIPPING
+			return FMalloc::TotalMallocCalls;
+		#else
+			return 0;
+		#endif
+	}
+
+	/* Times a single event, counting a transition when the current state changes. */
+	template <typename FuncType>
+	FORCEINLINE void Measure(FResult& Result, Machine* M, FuncType&& Event) {
+		auto Before = M->CurrentState;
+		const uint64 Start = FPlatformTime::Cycles64();
+		Event();
+		const uint64 End = FPlatformTime::Cycles64();
+
+		Result.EventCycles.Add(End - Start);
+		Result.Events += 1;
+		if (M->CurrentState != Before) {
+			Result.Transitions += 1;
+			Result.TransitionCycles += End - Start;
+		}
+	}
+
+	static void MoveLookFlood(FResult& Result, Machine* M) {
+		M->InputAxis = FVector2D(0.0f, 1.0f);
+		M->LookAxis = FVector2D(0.5f, 0.0f);
+		for (int i = 0; i < 8; ++i) {
+			Measure(Result, M, [M]() { M->AttemptMove(); });
+			Measure(Result, M, [M]() { M->AttemptLook(); });
+		}
+		M->RunPressed = true;
+		Measure(Result, M, [M]() { M->RunUpdate(); });
+		Measure(Result, M, [M]() { M->AttemptMove(); });
+		M->RunPressed = false;
+		Measure(Result, M, [M]() { M->RunUpdate(); });
+		Measure(Result, M, [M]() { M->StopMove(); });
+	}
+
+	static void CombatChain(FResult& Result, Machine* M) {
+		Measure(Result, M, [M]() { M->AttemptAttack(); });
+		Measure(Result, M, [M]() { M->AttackRecovery(); });
+		M->GuardPressed = true;
+		Measure(Result, M, [M]() { M->AttemptGuard(); });
+		Measure(Result, M, [M]() { M->DeflectionEvent(false); });
+		Measure(Result, M, [M]() { M->AttackRecovery(); });
+		Measure(Result, M, [M]() { M->AttemptAttack(); });
+		M->GuardPressed = false;
+		Measure(Result, M, [M]() { M->FinishGuard(); });
+		Measure(Result, M, [M]() { M->FinishAttack(); });
+	}
+
+	static void CastWhileMoving(FResult& Result, Machine* M) {
+		M->InputAxis = FVector2D(1.0f, 0.0f);
+		Measure(Result, M, [M]() { M->AttemptCast(); });
+		for (int i = 0; i < 4; ++i) {
+			Measure(Result, M, [M]() { M->AttemptMove(); });
+			Measure(Result, M, [M]() { M->AttemptLook(); });
+		}
+		Measure(Result, M, [M]() { M->StopMove(); });
+		Measure(Result, M, [M]() { M->FinishCast(); });
+	}
+
+	static void Run(FResult& Result, const TArray<APlaygroundCharacter*>& Characters, int32 Iterations,
+		void (*Script)(FResult&, Machine*)) 
+	{
+		Result.EventCycles.Reserve(Characters.Num() * Iterations * 24);
+		const uint64 Allocs = AllocationCount();
+		const double Start = FPlatformTime::Seconds();
+
+		for (int32 i = 0; i < Iterations; ++i) {
+			for (APlaygroundCharacter* Character : Characters) {
+				Script(Result, Character->GetMachine());
+			}
+		}
+
+		Result.Seconds = FPlatformTime::Seconds() - Start;
+		// Reserve above keeps the sample array itself out of the count.
+		Result.Allocations = AllocationCount() - Allocs;
+	}
+
+	static double Percentile(TArray<uint64>& Cycles, double P) {
+		if (Cycles.Num() == 0) {
+			return 0.0;
+		}
+		Cycles.Sort();
+		const int32 Index = FMath::Clamp((int32) (P * (Cycles.Num() - 1)), 0, Cycles.Num() - 1);
+		return FPlatformTime::ToSeconds64(Cycles[Index]) * 1e9;
+	}
+}
+
+UMachineBenchmarkCommandlet::UMachineBenchmarkCommandlet() {
+	this->IsClient = false;
+	this->IsEditor = false;
+	this->IsServer = false;
+	this->LogToConsole = true;
+}
+
+int32 UMachineBenchmarkCommandlet::Main(const FString& Params) {
+	using namespace MachineBenchmark;
+
+	int32 Instances = 64;
+	int32 Iterations = 200;
+	int32 ListenerCount = 4;
+	FString Output;
+
+	FParse::Value(*Params, TEXT("Instances="), Instances);
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	FParse::Value(*Params, TEXT("Listeners="), ListenerCount);
+	if (!FParse::Value(*Params, TEXT("Output="), Output)) {
+		Output = FPaths::Combine(FPaths::ProfilingDir(), TEXT("MachineBenchmark"),
+			FString::Printf(TEXT("MachineBenchmark_%s.csv"), *FDateTime::Now().ToString()));
+	}
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	FWorldContext& Context = GEngine->CreateNewWorldContext(EWorldType::Game);
+	Context.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	TArray<APlaygroundCharacter*> Characters;
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	for (int32 i = 0; i < Instances; ++i) {
+		FTransform Transform(FVector(200.0f * i, 0.0f, 0.0f));
+		if (auto Character = World->SpawnActor<APlaygroundCharacter>(APlaygroundCharacter::StaticClass(), Transform, SpawnParams)) {
+			Characters.Add(Character);
+		}
+	}
+
+	typedef void (*ScriptType)(FResult&, Machine*);
+	const TPair<const TCHAR*, ScriptType> Scripts[] = {
+		{ TEXT("MoveLookFlood"), &MoveLookFlood },
+		{ TEXT("CombatChain"), &CombatChain },
+		{ TEXT("CastWhileMoving"), &CastWhileMoving },
+	};
+
+	TArray<FResult> Results;
+	for (const auto& Script : Scripts) {
+		FResult& Result = Results.AddDefaulted_GetRef();
+		Result.Name = Script.Key;
+		Run(Result, Characters, Iterations, Script.Value);
+	}
+
+	// Second pass with listeners attached gives the dispatch cost by difference.
+	TArray<UMachineBenchmarkListener*> Listeners;
+	for (APlaygroundCharacter* Character : Characters) {
+		for (int32 i = 0; i < ListenerCount; ++i) {
+			auto Listener = NewObject<UMachineBenchmarkListener>(World);
+			Listeners.Add(Listener);
+
+			FStateChangeListener StateDel;
+			StateDel.BindDynamic(Listener, &UMachineBenchmarkListener::OnState);
+			Character->StateListen(StateDel);
+
+			FActionChangeListener ActionDel;
+			ActionDel.BindDynamic(Listener, &UMachineBenchmarkListener::OnAction);
+			Character->ActionListen(ActionDel);
+		}
+	}
+
+	const int32 Baseline = Results.Num();
+	for (const auto& Script : Scripts) {
+		FResult& Result = Results.AddDefaulted_GetRef();
+		Result.Name = FString::Printf(TEXT("%s+Listeners"), Script.Key);
+		Run(Result, Characters, Iterations, Script.Value);
+	}
+
+	FString Csv = TEXT("Scenario,Instances,Events,Transitions,NsPerEvent,NsPerTransition,P50Ns,P99Ns,AllocsPerEvent,ListenerNsPerEvent\n");
+	for (int32 i = 0; i < Results.Num(); ++i) {
+		FResult& Result = Results[i];
+		const double Events = FMath::Max<double>(1.0, Result.Events);
+		const double NsPerEvent = Result.Seconds * 1e9 / Events;
+		const double ListenerNs = i >= Baseline
+			? NsPerEvent - Results[i - Baseline].Seconds * 1e9 / FMath::Max<double>(1.0, Results[i - Baseline].Events)
+			: 0.0;
+
+		// Only the events that transitioned, so the ones that changed nothing aren't charged to them.
+		const double NsPerTransition = Result.Transitions > 0
+			? FPlatformTime::ToSeconds64(Result.TransitionCycles) * 1e9 / Result.Transitions
+			: 0.0;
+
+		const FString Line = FString::Printf(TEXT("%s,%d,%llu,%llu,%.2f,%.2f,%.2f,%.2f,%.4f,%.2f"),
+			*Result.Name, Characters.Num(), Result.Events, Result.Transitions,
+			NsPerEvent, NsPerTransition,
+			Percentile(Result.EventCycles, 0.5), Percentile(Result.EventCycles, 0.99),
+			Result.Allocations / Events, ListenerNs);
+
+		UE_LOG(LogTemp, Display, TEXT("%s"), *Line);
+		Csv += Line + TEXT("\n");
+	}
+
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(Output), true);
+	const bool bSaved = FFileHelper::SaveStringToFile(Csv, *Output);
+	UE_LOG(LogTemp, Display, TEXT("MachineBenchmark: Results %s %s"), bSaved ? TEXT("written to") : TEXT("could not be written to"), *Output);
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	return bSaved ? 0 : 1;
+}
@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PlaygroundCharacter.h"
+#include "MachineBenchmarkCommandlet.generated.h"
+
+/**
+ * Headless benchmark of PlaygroundCharacterStateMachine. Spawns characters into a bare game world and
+ * drives scripted input sequences through their machines, then writes per scenario timings as CSV.
+ *
+ * UnrealEditor-Cmd Playground.uproject -run=MachineBenchmark -nullrhi -unattended
+ *     [-Instances=64] [-Iterations=200] [-Listeners=4] [-Output=Path.csv]
+ */
+UCLASS()
+class UMachineBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMachineBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
+
+/**
+ * Counts the callbacks it receives, used to measure listener dispatch cost.
+ */
+UCLASS()
+class UMachineBenchmarkListener : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	int32 Calls = 0;
+
+	UFUNCTION()
+	void OnState(EPlaygroundCharacterState From, EPlaygroundCharacterState To) { ++this->Calls; }
+
+	UFUNCTION()
+	void OnAction(EPlaygroundCharacterActions Action, bool AddedQ) { ++this->Calls; }
+};
@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MachineStats.h"
+
+#if PLAYGROUND_MACHINE_STATS
+
+#include "HAL/IConsoleManager.h"
+#include "EngineUtils.h"
+#include "PlaygroundCharacter.h"
+
+DEFINE_STAT(STAT_MachineUpdateState);
+DEFINE_STAT(STAT_MachineListeners);
+CSV_DEFINE_CATEGORY(PlaygroundCharacter, true);
+
+#define STATE_PHASE_STATS(Name)                                                                         \
+	DECLARE_CYCLE_STAT(TEXT(#Name " Enter"), STAT_Machine##Name##Enter, STATGROUP_PlaygroundCharacter); \
+	DECLARE_CYCLE_STAT(TEXT(#Name " Exit"), STAT_Machine##Name##Exit, STATGROUP_PlaygroundCharacter);   \
+	DECLARE_CYCLE_STAT(TEXT(#Name " Step"), STAT_Machine##Name##Step, STATGROUP_PlaygroundCharacter);
+
+STATE_PHASE_STATS(Idle)
+STATE_PHASE_STATS(Walking)
+STATE_PHASE_STATS(Running)
+STATE_PHASE_STATS(Airborne)
+STATE_PHASE_STATS(Casting)
+STATE_PHASE_STATS(Attacking)
+
+#undef STATE_PHASE_STATS
+
+// Rows ordered by EPlaygroundCharacterState, like the machine's state IDs.
+static const int32 STAT_STATES = PlaygroundCharacterStateMachine::STATE_COUNT;
+
+TStatId MachineStats::GetStatId(EPhase Phase, uint8 State) {
+	#define STATE_PHASE_IDS(Name) { GET_STATID(STAT_Machine##Name##Enter), GET_STATID(STAT_Machine##Name##Exit), GET_STATID(STAT_Machine##Name##Step) }
+	static const TStatId Ids[STAT_STATES][3] = {
+		STATE_PHASE_IDS(Idle),
+		STATE_PHASE_IDS(Walking),
+		STATE_PHASE_IDS(Running),
+		STATE_PHASE_IDS(Airborne),
+		STATE_PHASE_IDS(Casting),
+		STATE_PHASE_IDS(Attacking),
+	};
+	#undef STATE_PHASE_IDS
+
+	return State < STAT_STATES ? Ids[State][(int32) Phase] : TStatId();
+}
+
+const char* MachineStats::GetCsvName(EPhase Phase, uint8 State) {
+	#define STATE_PHASE_NAMES(Name) { #Name "Enter", #Name "Exit", #Name "Step" }
+	static const char* Names[STAT_STATES][3] = {
+		STATE_PHASE_NAMES(Idle),
+		STATE_PHASE_NAMES(Walking),
+		STATE_PHASE_NAMES(Running),
+		STATE_PHASE_NAMES(Airborne),
+		STATE_PHASE_NAMES(Casting),
+		STATE_PHASE_NAMES(Attacking),
+	};
+	#undef STATE_PHASE_NAMES
+
+	return State < STAT_STATES ? Names[State][(int32) Phase] : "Unknown";
+}
+
+int32 FMachineStats::DwellBucket(double Seconds) {
+	const double Ms = Seconds * 1000.0;
+	if (Ms < 1.0) {
+		return 0;
+	}
+	return FMath::Min(DWELL_BUCKETS - 1, 1 + (int32) FMath::FloorLog2((uint32) Ms));
+}
+
+void FMachineStats::RecordTransition(uint8 From, uint8 To) {
+	const double Now = FPlatformTime::Seconds();
+	if (From < MAX_STATES && To < MAX_STATES) {
+		this->Edges[From][To] += 1;
+		if (this->EnteredAt > 0.0) {
+			this->Dwell[From][DwellBucket(Now - this->EnteredAt)] += 1;
+		}
+	}
+	this->EnteredAt = Now;
+
+	CSV_CUSTOM_STAT(PlaygroundCharacter, Transitions, 1, ECsvCustomStatOp::Accumulate);
+}
+
+FMachineStats::FRedirectScope::FRedirectScope(FMachineStats& InStats): Stats(InStats) {
+	this->Stats.RedirectDepth += 1;
+	if (this->Stats.RedirectDepth > this->Stats.MaxRedirectDepth) {
+		this->Stats.MaxRedirectDepth = this->Stats.RedirectDepth;
+	}
+	CSV_CUSTOM_STAT(PlaygroundCharacter, RedirectDepth, this->Stats.RedirectDepth, ECsvCustomStatOp::Max);
+}
+
+void FMachineStats::Log(const FString& Owner) const {
+	auto Name = [](int32 State) { return UEnum::GetValueAsString((EPlaygroundCharacterState) State); };
+
+	UE_LOG(LogTemp, Log, TEXT("%s: max redirect depth %d"), *Owner, this->MaxRedirectDepth);
+	for (int32 From = 0; From < MAX_STATES; ++From) {
+		for (int32 To = 0; To < MAX_STATES; ++To) {
+			if (this->Edges[From][To] > 0) {
+				UE_LOG(LogTemp, Log, TEXT("  %s -> %s: %u"), *Name(From), *Name(To), this->Edges[From][To]);
+			}
+		}
+	}
+
+	for (int32 State = 0; State < MAX_STATES; ++State) {
+		FString Line;
+		uint32 Total = 0;
+		for (int32 b = 0; b < DWELL_BUCKETS; ++b) {
+			Line += FString::Printf(TEXT(" %u"), this->Dwell[State][b]);
+			Total += this->Dwell[State][b];
+		}
+		if (Total > 0) {
+			UE_LOG(LogTemp, Log, TEXT("  %s dwell (<1ms, <2ms, <4ms, ...):%s"), *Name(State), *Line);
+		}
+	}
+}
+
+static void DumpMachineStats(const TArray<FString>& Args, UWorld* World) {
+	if (World == nullptr) {
+		return;
+	}
+
+	for (TActorIterator<APlaygroundCharacter> It(World); It; ++It) {
+		It->GetMachine()->Stats.Log(It->GetName());
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GDumpMachineStatsCommand(
+	TEXT("Playground.DumpMachineStats"),
+	TEXT("Logs transition counts, dwell time histograms and redirect depth of every character state machine."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&DumpMachineStats));
+
+#endif
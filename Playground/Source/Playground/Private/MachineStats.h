@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+// Instrumentation of PlaygroundCharacterStateMachine, compiled out entirely in Shipping.
+#define PLAYGROUND_MACHINE_STATS !UE_BUILD_SHIPPING
+
+#if PLAYGROUND_MACHINE_STATS
+
+DECLARE_STATS_GROUP(TEXT("PlaygroundCharacter"), STATGROUP_PlaygroundCharacter, STATCAT_Advanced);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("UpdateState"), STAT_MachineUpdateState, STATGROUP_PlaygroundCharacter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Listener Dispatch"), STAT_MachineListeners, STATGROUP_PlaygroundCharacter, );
+CSV_DECLARE_CATEGORY_EXTERN(PlaygroundCharacter);
+
+/**
+ * Per machine transition counters and dwell time histograms, indexed by EPlaygroundCharacterState.
+ */
+struct FMachineStats
+{
+	static constexpr int32 MAX_STATES = 8;
+	// Bucket 0 is under 1ms, bucket i covers [2^(i-1), 2^i) ms, the last bucket is open ended.
+	static constexpr int32 DWELL_BUCKETS = 14;
+
+	uint32 Edges[MAX_STATES][MAX_STATES] = {};
+	uint32 Dwell[MAX_STATES][DWELL_BUCKETS] = {};
+	double EnteredAt = 0.0;
+	int32 RedirectDepth = 0;
+	int32 MaxRedirectDepth = 0;
+
+	void RecordTransition(uint8 From, uint8 To);
+	void Log(const FString& Owner) const;
+
+	static int32 DwellBucket(double Seconds);
+
+	/* Tracks how deep Enter() redirects recurse through UpdateState. */
+	struct FRedirectScope {
+		FMachineStats& Stats;
+
+		FRedirectScope(FMachineStats& InStats);
+		~FRedirectScope() { this->Stats.RedirectDepth -= 1; }
+	};
+};
+
+namespace MachineStats {
+	enum class EPhase : uint8 { ENTER, EXIT, STEP };
+
+	TStatId GetStatId(EPhase Phase, uint8 State);
+	const char* GetCsvName(EPhase Phase, uint8 State);
+}
+
+#if CSV_PROFILER
+	#define MACHINE_CSV_SCOPE(Name) FScopedCsvStat ANONYMOUS_VARIABLE(MachineCsv)(Name, CSV_CATEGORY_INDEX(PlaygroundCharacter))
+#else
+	#define MACHINE_CSV_SCOPE(Name)
+#endif
+
+/* Times the rest of the scope under one of the fixed machine stats, e.g. MACHINE_SCOPE(UpdateState). */
+#define MACHINE_SCOPE(Name) \
+	SCOPE_CYCLE_COUNTER(STAT_Machine##Name); \
+	MACHINE_CSV_SCOPE(#Name)
+
+/* Times the rest of the scope under the stat of a state's Enter, Exit or Step. */
+#define MACHINE_PHASE_SCOPE(Phase, State) \
+	FScopeCycleCounter ANONYMOUS_VARIABLE(MachineCycle)(MachineStats::GetStatId(MachineStats::EPhase::Phase, State)); \
+	MACHINE_CSV_SCOPE(MachineStats::GetCsvName(MachineStats::EPhase::Phase, State))
+
+#else
+
+#define MACHINE_SCOPE(Name)
+#define MACHINE_PHASE_SCOPE(Phase, State)
+
+#endif
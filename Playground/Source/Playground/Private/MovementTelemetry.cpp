@@ -0,0 +1,138 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MovementTelemetry.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryWriter.h"
+#include "HAL/FileManager.h"
+
+static const uint32 TELEMETRY_VERSION = 1;
+// Offset of the sample count in the binary layout.
+static const int64 COUNT_OFFSET = 8;
+
+static void WriteHeader(FArchive& Writer, uint32 Count) {
+	uint8 Magic[4] = { 'P', 'G', 'M', 'T' };
+	Writer.Serialize(Magic, 4);
+
+	uint32 Version = TELEMETRY_VERSION;
+	Writer << Version << Count;
+}
+
+static void WriteSamples(FArchive& Writer, TArray<FMovementSample>& Data) {
+	for (FMovementSample& s : Data) {
+		Writer << s.Frame << s.DeltaTime;
+		Writer << s.OldLocation << s.NewLocation << s.Velocity;
+		Writer << s.MovementMode << s.CustomMovementMode;
+	}
+}
+
+FMovementTelemetry::FMovementTelemetry(): Head(0), Writing(0) {
+	this->Samples.SetNumUninitialized(CAPACITY);
+}
+
+FMovementTelemetry::~FMovementTelemetry() {
+	this->StopStream();
+	this->StreamPipe.WaitUntilEmpty();
+}
+
+int32 FMovementTelemetry::Num() const {
+	return (int32) FMath::Min(this->Head.load(std::memory_order_acquire), CAPACITY);
+}
+
+void FMovementTelemetry::Snapshot(TArray<FMovementSample>& Out) const {
+	const uint32 End = this->Head.load(std::memory_order_acquire);
+	const uint32 Count = FMath::Min(End, CAPACITY);
+
+	Out.Reset(Count);
+	for (uint32 i = End - Count; i != End; ++i) {
+		Out.Add(this->Samples[i & (CAPACITY - 1)]);
+	}
+
+	// Samples older than Writing - CAPACITY shared a slot with one written during the copy.
+	std::atomic_thread_fence(std::memory_order_acquire);
+	const uint32 Writing = this->Writing.load(std::memory_order_relaxed);
+	const uint32 Overwritten = Writing - (End - Count) > CAPACITY ? Writing - (End - Count) - CAPACITY : 0;
+	Out.RemoveAt(0, FMath::Min<int32>(Overwritten, Out.Num()), false);
+}
+
+bool FMovementTelemetry::SaveCSV(const FString& Path) const {
+	TArray<FMovementSample> Data;
+	this->Snapshot(Data);
+
+	FString Out = TEXT("Frame,DeltaTime,OldX,OldY,OldZ,NewX,NewY,NewZ,VelX,VelY,VelZ,Mode,CustomMode\n");
+	Out.Reserve(Out.Len() + Data.Num() * 128);
+	for (const FMovementSample& s : Data) {
+		Out += FString::Printf(TEXT("%u,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%u,%u\n"),
+			s.Frame, s.DeltaTime,
+			s.OldLocation.X, s.OldLocation.Y, s.OldLocation.Z,
+			s.NewLocation.X, s.NewLocation.Y, s.NewLocation.Z,
+			s.Velocity.X, s.Velocity.Y, s.Velocity.Z,
+			s.MovementMode, s.CustomMovementMode);
+	}
+
+	return FFileHelper::SaveStringToFile(Out, *Path);
+}
+
+bool FMovementTelemetry::SaveBinary(const FString& Path) const {
+	TArray<FMovementSample> Data;
+	this->Snapshot(Data);
+
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	WriteHeader(Writer, Data.Num());
+	WriteSamples(Writer, Data);
+
+	return FFileHelper::SaveArrayToFile(Bytes, *Path);
+}
+
+bool FMovementTelemetry::StartStream(const FString& Path) {
+	this->StopStream();
+
+	FArchive* File = IFileManager::Get().CreateFileWriter(*Path);
+	if (File == nullptr) {
+		return false;
+	}
+
+	// The count is patched by StopStream.
+	WriteHeader(*File, 0);
+	this->StreamFile = MakeShareable(File);
+	this->Streamed = this->Head.load(std::memory_order_relaxed);
+	this->StreamedCount = 0;
+	return true;
+}
+
+void FMovementTelemetry::StopStream() {
+	if (!this->StreamFile.IsValid()) {
+		return;
+	}
+
+	this->FlushStream();
+	this->StreamPipe.Launch(TEXT("MovementTelemetryClose"),
+		[File = MoveTemp(this->StreamFile), Count = this->StreamedCount]() mutable {
+			File->Seek(COUNT_OFFSET);
+			*File << Count;
+			File->Close();
+		});
+}
+
+void FMovementTelemetry::FlushStream() {
+	const uint32 End = this->Head.load(std::memory_order_relaxed);
+	const uint32 Count = End - this->Streamed;
+	if (Count == 0) {
+		return;
+	}
+
+	// The game thread is the only writer, so the block can be copied without checking Writing.
+	TArray<FMovementSample> Block;
+	Block.Reserve(Count);
+	for (uint32 i = this->Streamed; i != End; ++i) {
+		Block.Add(this->Samples[i & (CAPACITY - 1)]);
+	}
+	this->Streamed = End;
+	this->StreamedCount += Count;
+
+	this->StreamPipe.Launch(TEXT("MovementTelemetryWrite"),
+		[File = this->StreamFile, Block = MoveTemp(Block)]() mutable {
+			WriteSamples(*File, Block);
+		});
+}
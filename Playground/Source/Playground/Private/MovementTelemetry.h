@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tasks/Pipe.h"
+#include <atomic>
+
+/**
+ * One movement update of a character movement component.
+ */
+struct FMovementSample
+{
+	uint32 Frame;
+	float DeltaTime;
+	FVector3f OldLocation;
+	FVector3f NewLocation;
+	FVector3f Velocity;
+	uint8 MovementMode;
+	uint8 CustomMovementMode;
+};
+
+/**
+ * Fixed capacity ring buffer of movement samples. Recording never allocates and overwrites the
+ * oldest samples once full. The game thread is the only writer. It announces the slot it is about to
+ * overwrite before writing it, and Snapshot checks that announcement after copying, dropping any sample
+ * that could have been overwritten meanwhile. A dump on another thread therefore only returns complete
+ * samples, possibly fewer than CAPACITY while recording is running.
+ *
+ * While a stream is open, every BLOCK samples are copied out of the ring on the game thread and appended
+ * to the stream file by a task pipe, so the file holds the whole session rather than the last CAPACITY.
+ * That copy is the only allocation, once per BLOCK samples.
+ */
+class FMovementTelemetry
+{
+public:
+	// Must be a power of two.
+	static constexpr uint32 CAPACITY = 4096;
+	// Samples handed to the stream writer at once, at most CAPACITY.
+	static constexpr uint32 BLOCK = 512;
+
+	FMovementTelemetry();
+	~FMovementTelemetry();
+
+	FORCEINLINE void Record(const FMovementSample& Sample) {
+		const uint32 Index = this->Head.load(std::memory_order_relaxed);
+		this->Writing.store(Index + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		this->Samples[Index & (CAPACITY - 1)] = Sample;
+		this->Head.store(Index + 1, std::memory_order_release);
+
+		if (this->StreamFile.IsValid() && Index + 1 - this->Streamed >= BLOCK) {
+			this->FlushStream();
+		}
+	}
+
+	int32 Num() const;
+
+	/* Copies the buffered samples, oldest first. */
+	void Snapshot(TArray<FMovementSample>& Out) const;
+
+	bool SaveCSV(const FString& Path) const;
+
+	/* Binary layout: "PGMT", uint32 version, uint32 count, then count packed samples. */
+	bool SaveBinary(const FString& Path) const;
+
+	/* Starts appending every sample recorded from now on to Path, in the SaveBinary layout. */
+	bool StartStream(const FString& Path);
+
+	/* Writes the samples not yet streamed, patches the count and closes the file once written. */
+	void StopStream();
+
+	bool IsStreaming() const { return this->StreamFile.IsValid(); }
+
+private:
+	/* Hands the samples recorded since the last flush to the stream pipe. Game thread only. */
+	void FlushStream();
+
+	// Shared with the pending write tasks, which run in order on StreamPipe.
+	TSharedPtr<FArchive> StreamFile;
+	UE::Tasks::FPipe StreamPipe{ TEXT("MovementTelemetryStream") };
+	// Head at the last flush, and the samples streamed since StartStream.
+	uint32 Streamed = 0;
+	uint32 StreamedCount = 0;
+
+	TArray<FMovementSample> Samples;
+	std::atomic<uint32> Head;
+	// Head once the sample being written is published, the slot of sample Writing - 1 may be torn.
+	std::atomic<uint32> Writing;
+};
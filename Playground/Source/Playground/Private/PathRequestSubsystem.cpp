@@ -0,0 +1,255 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PathRequestSubsystem.h"
+#include "AIController.h"
+#include "NavigationSystem.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "NavMesh/NavMeshPath.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_STATS_GROUP(TEXT("PathRequests"), STATGROUP_PathRequests, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Queued"), STAT_PathRequestsQueued, STATGROUP_PathRequests);
+DECLARE_DWORD_COUNTER_STAT(TEXT("In Flight"), STAT_PathRequestsInFlight, STATGROUP_PathRequests);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Cached Paths"), STAT_PathRequestsCached, STATGROUP_PathRequests);
+
+UPathRequestSubsystem::FSegmentKey UPathRequestSubsystem::MakeKey(const FVector& Start, const FVector& End,
+	const ANavigationData* NavData) const
+{
+	const float Inv = 1.0f / FMath::Max(1.0f, this->SegmentTolerance);
+	auto Snap = [Inv](const FVector& V) {
+		return FIntVector(FMath::RoundToInt(V.X * Inv), FMath::RoundToInt(V.Y * Inv), FMath::RoundToInt(V.Z * Inv));
+	};
+	return { Snap(Start), Snap(End), NavData };
+}
+
+uint32 UPathRequestSubsystem::RequestPath(const AAIController* Controller, const FVector& Goal, bool bCache,
+	FPathRequestListener Listener)
+{
+	if (Controller == nullptr || Controller->GetPawn() == nullptr) {
+		return 0;
+	}
+
+	return this->RequestSegment(Controller, Controller->GetNavAgentLocation(), Goal, bCache, Listener);
+}
+
+uint32 UPathRequestSubsystem::RequestSegment(const AAIController* Controller, const FVector& Start, const FVector& Goal,
+	bool bCache, FPathRequestListener Listener)
+{
+	auto NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(this->GetWorld());
+	const APawn* Pawn = Controller ? Controller->GetPawn() : nullptr;
+
+	if (NavSys == nullptr || Pawn == nullptr) {
+		return 0;
+	}
+
+	const FNavAgentProperties& Agent = Controller->GetNavAgentPropertiesRef();
+	const ANavigationData* NavData = NavSys->GetNavDataForProps(Agent, Pawn->GetActorLocation());
+	if (NavData == nullptr) {
+		return 0;
+	}
+
+	const uint32 Id = this->NextId++;
+	this->Pending.Add(Id);
+	this->Queued.Add({ Id, this->MakeKey(Start, Goal, NavData), Start, Goal, Agent, Controller, Listener, bCache });
+	return Id;
+}
+
+bool UPathRequestSubsystem::RequestPathAsync(AAIController* Controller, FVector Goal, bool bCache, FPathRequestListener Listener) {
+	return this->RequestPath(Controller, Goal, bCache, Listener) != 0;
+}
+
+EPathRequestStatus UPathRequestSubsystem::PollPath(uint32 Id, FNavPathSharedPtr& OutPath) {
+	if (FResult* Result = this->Results.Find(Id)) {
+		OutPath = Result->Path;
+		this->Results.Remove(Id);
+		return OutPath.IsValid() ? EPathRequestStatus::READY : EPathRequestStatus::FAILED;
+	}
+
+	return this->Pending.Contains(Id) ? EPathRequestStatus::PENDING : EPathRequestStatus::UNKNOWN;
+}
+
+bool UPathRequestSubsystem::MoveAlongPath(AAIController* Controller, FNavPathSharedPtr Path, float AcceptanceRadius) {
+	if (Controller == nullptr || !Path.IsValid() || Path->GetPathPoints().Num() == 0) {
+		return false;
+	}
+
+	FAIMoveRequest Request(Path->GetEndLocation());
+	Request.SetAcceptanceRadius(AcceptanceRadius);
+	return Controller->RequestMove(Request, Path).IsValid();
+}
+
+FNavPathSharedPtr UPathRequestSubsystem::CopyPath(const FNavPathSharedPtr& Path, FDelegateHandle Observer) {
+	FNavPathSharedPtr Copy;
+	if (const FNavMeshPath* MeshPath = Path->CastPath<FNavMeshPath>()) {
+		Copy = MakeShared<FNavMeshPath, ESPMode::ThreadSafe>(*MeshPath);
+	} else {
+		Copy = MakeShared<FNavigationPath, ESPMode::ThreadSafe>(*Path);
+	}
+
+	if (Observer.IsValid()) {
+		Copy->RemoveObserver(Observer);
+	}
+
+	Copy->EnableRecalculationOnInvalidation(true);
+	if (ANavigationData* NavData = Copy->GetNavigationDataUsed()) {
+		NavData->RegisterActivePath(Copy);
+	}
+	return Copy;
+}
+
+void UPathRequestSubsystem::Complete(const FWaiter& Waiter, FNavPathSharedPtr Path, bool bShared, FDelegateHandle Observer) {
+	this->Pending.Remove(Waiter.Id);
+
+	if (Waiter.Listener.IsBound()) {
+		TArray<FVector> Points;
+		if (Path.IsValid()) {
+			for (const FNavPathPoint& Point : Path->GetPathPoints()) {
+				Points.Add(Point.Location);
+			}
+		}
+		Waiter.Listener.Execute(Path.IsValid(), Points);
+	} else {
+		// Path following writes to the path it follows and recalculates it in place.
+		this->Results.Add(Waiter.Id, { bShared && Path.IsValid() ? CopyPath(Path, Observer) : Path, FPlatformTime::Seconds() });
+	}
+}
+
+void UPathRequestSubsystem::Tick(float DeltaTime) {
+	auto NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(this->GetWorld());
+	int32 Started = 0;
+	int32 Handled = 0;
+
+	for (; Handled < this->Queued.Num() && Started < this->MaxQueriesPerFrame; ++Handled) {
+		FRequest& Request = this->Queued[Handled];
+		const FWaiter Waiter = { Request.Id, Request.Listener };
+
+		if (Request.bCache) {
+			if (FCachedPath* Cached = this->Cache.Find(Request.Key)) {
+				if (Cached->Path->IsValid() && Cached->Path->IsUpToDate()) {
+					++this->CacheHits;
+					this->Complete(Waiter, Cached->Path, true, Cached->Observer);
+					continue;
+				}
+				this->Cache.Remove(Request.Key);
+			}
+		}
+
+		if (uint32* QueryId = this->InFlightBySegment.Find(Request.Key)) {
+			++this->SharedHits;
+			this->InFlight[*QueryId].Waiters.Add(Waiter);
+			continue;
+		}
+
+		const ANavigationData* NavData = Request.Key.NavData;
+		if (NavSys == nullptr || !IsValid(NavData)) {
+			this->Complete(Waiter, nullptr);
+			continue;
+		}
+
+		FPathFindingQuery Query(Request.Querier.Get(), *NavData, Request.Start, Request.End);
+		const uint32 QueryId = NavSys->FindPathAsync(Request.Agent, Query,
+			FNavPathQueryDelegate::CreateUObject(this, &UPathRequestSubsystem::OnPathFound),
+			EPathFindingMode::Regular);
+
+		if (QueryId == INVALID_NAVQUERYID) {
+			this->Complete(Waiter, nullptr);
+			continue;
+		}
+
+		this->InFlight.Add(QueryId, { Request.Key, Request.bCache, { Waiter } });
+		this->InFlightBySegment.Add(Request.Key, QueryId);
+		++this->Queries;
+		++Started;
+	}
+
+	this->Queued.RemoveAt(0, Handled, false);
+
+	const double Now = FPlatformTime::Seconds();
+	for (auto It = this->Results.CreateIterator(); It; ++It) {
+		if (Now - It.Value().Time > this->ResultLifetime) {
+			It.RemoveCurrent();
+		}
+	}
+
+	SET_DWORD_STAT(STAT_PathRequestsQueued, this->Queued.Num());
+	SET_DWORD_STAT(STAT_PathRequestsInFlight, this->InFlight.Num());
+	SET_DWORD_STAT(STAT_PathRequestsCached, this->Cache.Num());
+}
+
+void UPathRequestSubsystem::OnPathFound(uint32 QueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path) {
+	FInFlight Flight;
+	if (!this->InFlight.RemoveAndCopyValue(QueryId, Flight)) {
+		return;
+	}
+	this->InFlightBySegment.Remove(Flight.Key);
+
+	FDelegateHandle Observer;
+	if (Result != ENavigationQueryResult::Success || !Path.IsValid()) {
+		Path = nullptr;
+	} else if (Flight.bCache) {
+		// The cached path is only a template that copies are made from, and is dropped instead of
+		// recalculated when the navmesh tiles it crosses are rebuilt.
+		Path->EnableRecalculationOnInvalidation(false);
+		Observer = Path->AddObserver(FNavigationPath::FPathObserverDelegate::FDelegate::CreateUObject(
+			this, &UPathRequestSubsystem::OnCachedPathEvent, Flight.Key));
+
+		if (ANavigationData* NavData = Path->GetNavigationDataUsed()) {
+			NavData->RegisterActivePath(Path);
+		}
+
+		this->Cache.Add(Flight.Key, { Path, Observer });
+	}
+
+	for (int32 i = 0; i < Flight.Waiters.Num(); ++i) {
+		// Without caching the first waiter can keep the query's own path.
+		this->Complete(Flight.Waiters[i], Path, Flight.bCache || i > 0, Observer);
+	}
+}
+
+void UPathRequestSubsystem::OnCachedPathEvent(FNavigationPath* Path, ENavPathEvent::Type Event, FSegmentKey Key) {
+	if (Event == ENavPathEvent::Invalidated) {
+		const FCachedPath* Cached = this->Cache.Find(Key);
+		if (Cached && Cached->Path.Get() == Path) {
+			this->Cache.Remove(Key);
+		}
+	}
+}
+
+void UPathRequestSubsystem::ClearCache() {
+	this->Cache.Reset();
+}
+
+void UPathRequestSubsystem::Deinitialize() {
+	if (auto NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(this->GetWorld())) {
+		for (const auto& Pair : this->InFlight) {
+			NavSys->AbortAsyncFindPathRequest(Pair.Key);
+		}
+	}
+
+	this->Queued.Reset();
+	this->InFlight.Reset();
+	this->InFlightBySegment.Reset();
+	this->Results.Reset();
+	this->Pending.Reset();
+	this->Cache.Reset();
+	Super::Deinitialize();
+}
+
+TStatId UPathRequestSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPathRequestSubsystem, STATGROUP_Tickables);
+}
+
+void UPathRequestSubsystem::LogStats() const {
+	UE_LOG(LogTemp, Log, TEXT("PathRequests: %d queries, %d cache hits, %d shared, %d cached paths, %d queued, %d in flight"),
+		this->Queries, this->CacheHits, this->SharedHits, this->Cache.Num(), this->Queued.Num(), this->InFlight.Num());
+}
+
+static FAutoConsoleCommandWithWorld GDumpPathRequestsCommand(
+	TEXT("Playground.DumpPathRequests"),
+	TEXT("Logs query, cache hit and shared request counts of the path request service."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World) {
+		if (auto Subsystem = UWorld::GetSubsystem<UPathRequestSubsystem>(World)) {
+			Subsystem->LogStats();
+		}
+	}));
@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "NavigationData.h"
+#include "PathRequestSubsystem.generated.h"
+
+class AAIController;
+
+UENUM(BlueprintType)
+enum class EPathRequestStatus : uint8 {
+	PENDING            UMETA(DisplayName = "Pending"),
+	READY              UMETA(DisplayName = "Ready"),
+	FAILED             UMETA(DisplayName = "Failed"),
+	/** Never requested, already taken, or expired. **/
+	UNKNOWN            UMETA(DisplayName = "Unknown"),
+};
+
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FPathRequestListener, bool, bSuccess, const TArray<FVector>&, Points);
+
+/**
+ * Queues path requests and resolves them through the navigation system's async queries, which run
+ * batched on a worker thread. At most MaxQueriesPerFrame queries are started each frame, requests for
+ * the same segment share one query, and cacheable requests (patrol legs, which never change) reuse
+ * earlier results until the navmesh tiles under the path are rebuilt.
+ *
+ * Cached paths are only templates: every request polled for a path gets its own copy, which recalculates
+ * itself when the navmesh under it changes like any path from the navigation system.
+ */
+UCLASS(Config=Game)
+class UPathRequestSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Quantized segment of a request, requests with equal keys share a result. **/
+	struct FSegmentKey {
+		FIntVector Start;
+		FIntVector End;
+		const ANavigationData* NavData;
+
+		FORCEINLINE bool operator==(const FSegmentKey& Other) const {
+			return this->Start == Other.Start && this->End == Other.End && this->NavData == Other.NavData;
+		}
+
+		friend FORCEINLINE uint32 GetTypeHash(const FSegmentKey& Key) {
+			return HashCombine(HashCombine(GetTypeHash(Key.Start), GetTypeHash(Key.End)), PointerHash(Key.NavData));
+		}
+	};
+
+private:
+	struct FRequest {
+		uint32 Id;
+		FSegmentKey Key;
+		FVector Start;
+		FVector End;
+		FNavAgentProperties Agent;
+		TWeakObjectPtr<const UObject> Querier;
+		FPathRequestListener Listener;
+		bool bCache;
+	};
+
+	struct FWaiter {
+		uint32 Id;
+		FPathRequestListener Listener;
+	};
+
+	struct FInFlight {
+		FSegmentKey Key;
+		bool bCache;
+		TArray<FWaiter> Waiters;
+	};
+
+	struct FResult {
+		FNavPathSharedPtr Path;
+		double Time;
+	};
+
+	struct FCachedPath {
+		FNavPathSharedPtr Path;
+		// OnCachedPathEvent on the template, which copies must not carry.
+		FDelegateHandle Observer;
+	};
+
+	TArray<FRequest> Queued;
+	// Keyed by navigation query id.
+	TMap<uint32, FInFlight> InFlight;
+	TMap<FSegmentKey, uint32> InFlightBySegment;
+	// Keyed by request id, until polled or expired.
+	TMap<uint32, FResult> Results;
+	// Ids of requests that are queued or waiting on a query.
+	TSet<uint32> Pending;
+	TMap<FSegmentKey, FCachedPath> Cache;
+	uint32 NextId = 1;
+
+	int32 CacheHits = 0;
+	int32 SharedHits = 0;
+	int32 Queries = 0;
+
+public:
+	/** Async queries started per frame, the rest wait in the queue. **/
+	UPROPERTY(Config, EditAnywhere, Category = "Pathfinding")
+	int32 MaxQueriesPerFrame = 16;
+
+	/** Size of the grid request end points are snapped to when matching segments. **/
+	UPROPERTY(Config, EditAnywhere, Category = "Pathfinding")
+	float SegmentTolerance = 50.0f;
+
+	/** Seconds an unpolled result is kept. **/
+	UPROPERTY(Config, EditAnywhere, Category = "Pathfinding")
+	float ResultLifetime = 5.0f;
+
+	/**
+	 * Queues a path from the controller's pawn to Goal. Cache only segments that are requested again,
+	 * such as patrol legs. Returns 0 if the controller has no pawn or the world no navigation data.
+	 **/
+	uint32 RequestPath(const AAIController* Controller, const FVector& Goal, bool bCache, FPathRequestListener Listener = FPathRequestListener());
+
+	/** Queues a path between two fixed points for the controller's agent, such as consecutive patrol points. **/
+	uint32 RequestSegment(const AAIController* Controller, const FVector& Start, const FVector& Goal, bool bCache,
+		FPathRequestListener Listener = FPathRequestListener());
+
+	/** Status of a request. When READY, takes the path out and the id becomes unknown. **/
+	EPathRequestStatus PollPath(uint32 Id, FNavPathSharedPtr& OutPath);
+
+	/** Queues a path and calls Listener with its points once resolved. **/
+	UFUNCTION(BlueprintCallable, Category = "Pathfinding")
+	bool RequestPathAsync(AAIController* Controller, FVector Goal, bool bCache, FPathRequestListener Listener);
+
+	/** Starts a controller moving along a resolved path. **/
+	static bool MoveAlongPath(AAIController* Controller, FNavPathSharedPtr Path, float AcceptanceRadius);
+
+	UFUNCTION(BlueprintCallable, Category = "Pathfinding")
+	void ClearCache();
+
+	void LogStats() const;
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	FSegmentKey MakeKey(const FVector& Start, const FVector& End, const ANavigationData* NavData) const;
+	/* Hands Path to the waiter, copying it first when other waiters or the cache hold it too. */
+	void Complete(const FWaiter& Waiter, FNavPathSharedPtr Path, bool bShared = false, FDelegateHandle Observer = FDelegateHandle());
+	static FNavPathSharedPtr CopyPath(const FNavPathSharedPtr& Path, FDelegateHandle Observer);
+	void OnPathFound(uint32 QueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path);
+	void OnCachedPathEvent(FNavigationPath* Path, ENavPathEvent::Type Event, FSegmentKey Key);
+};
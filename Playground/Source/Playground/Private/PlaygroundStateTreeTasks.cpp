@@ -0,0 +1,229 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PlaygroundStateTreeTasks.h"
+#include "FactionSubsystem.h"
+#include "PathRequestSubsystem.h"
+#include "StateTreeExecutionContext.h"
+#include "AIController.h"
+#include "Components/SplineComponent.h"
+#include "Navigation/PathFollowingComponent.h"
+
+/*
+ * Maps the path following state of a move to a run status. GoalRadius is the collision radius of a goal
+ * actor, which path following stops at the edge of.
+ */
+static EStateTreeRunStatus PollMove(const AAIController* Controller, const FVector& Goal, float AcceptanceRadius, float GoalRadius = 0.0f) {
+	if (Controller == nullptr || Controller->GetPawn() == nullptr) {
+		return EStateTreeRunStatus::Failed;
+	}
+
+	if (Controller->GetMoveStatus() != EPathFollowingStatus::Idle) {
+		return EStateTreeRunStatus::Running;
+	}
+
+	// Allow for the capsule, path following accepts goals at the edge of the pawn.
+	const float Reach = AcceptanceRadius + GoalRadius + Controller->GetPawn()->GetSimpleCollisionRadius();
+	return FVector::DistSquared2D(Controller->GetPawn()->GetActorLocation(), Goal) <= Reach * Reach
+		? EStateTreeRunStatus::Succeeded
+		: EStateTreeRunStatus::Failed;
+}
+
+static EStateTreeRunStatus StartMove(AAIController* Controller, const FVector& Goal, float AcceptanceRadius) {
+	if (Controller == nullptr) {
+		return EStateTreeRunStatus::Failed;
+	}
+
+	switch (Controller->MoveToLocation(Goal, AcceptanceRadius)) {
+		case EPathFollowingRequestResult::AlreadyAtGoal:
+			return EStateTreeRunStatus::Succeeded;
+		case EPathFollowingRequestResult::RequestSuccessful:
+			return EStateTreeRunStatus::Running;
+		default:
+			return EStateTreeRunStatus::Failed;
+	}
+}
+
+static void StopMove(AAIController* Controller) {
+	if (Controller && Controller->GetMoveStatus() != EPathFollowingStatus::Idle) {
+		Controller->StopMovement();
+	}
+}
+
+/* Queues an async path for a move, falling back to a direct move without the path request service. */
+static EStateTreeRunStatus RequestMove(AAIController* Controller, const FVector* Start, const FVector& Goal,
+	float AcceptanceRadius, bool bCache, uint32& Request)
+{
+	auto Paths = Controller ? UWorld::GetSubsystem<UPathRequestSubsystem>(Controller->GetWorld()) : nullptr;
+
+	if (Paths) {
+		Request = Start
+			? Paths->RequestSegment(Controller, *Start, Goal, bCache)
+			: Paths->RequestPath(Controller, Goal, bCache);
+	}
+
+	if (Request == 0) {
+		return StartMove(Controller, Goal, AcceptanceRadius);
+	}
+
+	return EStateTreeRunStatus::Running;
+}
+
+/* Starts following the path once the request resolves, then polls the move. */
+static EStateTreeRunStatus PollRequestedMove(AAIController* Controller, const FVector& Goal, float AcceptanceRadius, uint32& Request) {
+	if (Request == 0) {
+		return PollMove(Controller, Goal, AcceptanceRadius);
+	}
+
+	auto Paths = Controller ? UWorld::GetSubsystem<UPathRequestSubsystem>(Controller->GetWorld()) : nullptr;
+	FNavPathSharedPtr Path;
+
+	switch (Paths ? Paths->PollPath(Request, Path) : EPathRequestStatus::UNKNOWN) {
+		case EPathRequestStatus::PENDING:
+			return EStateTreeRunStatus::Running;
+		case EPathRequestStatus::READY:
+			Request = 0;
+			return UPathRequestSubsystem::MoveAlongPath(Controller, Path, AcceptanceRadius)
+				? EStateTreeRunStatus::Running
+				: EStateTreeRunStatus::Failed;
+		default:
+			Request = 0;
+			return EStateTreeRunStatus::Failed;
+	}
+}
+
+static bool GetPatrolPoint(const AActor* Route, int32& Index, FVector& Out) {
+	const USplineComponent* Spline = Route ? Route->FindComponentByClass<USplineComponent>() : nullptr;
+	const int32 Count = Spline ? Spline->GetNumberOfSplinePoints() : 0;
+
+	if (Count == 0) {
+		return false;
+	}
+
+	Index = (Index % Count + Count) % Count;
+	Out = Spline->GetLocationAtSplinePoint(Index, ESplineCoordinateSpace::World);
+	return true;
+}
+
+EStateTreeRunStatus FPlaygroundPatrolTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const {
+	FInstanceDataType& Data = Context.GetInstanceData(*this);
+	FVector Point, Previous;
+
+	if (!GetPatrolPoint(Data.Route, Data.Index, Point)) {
+		return EStateTreeRunStatus::Failed;
+	}
+
+	// Legs that start at the previous route point are the same for every NPC on the route.
+	int32 PreviousIndex = Data.Index - 1;
+	const bool bSegment = Data.bOnRoute && GetPatrolPoint(Data.Route, PreviousIndex, Previous);
+
+	Data.PathRequest = 0;
+	const EStateTreeRunStatus Status = RequestMove(Data.Controller, bSegment ? &Previous : nullptr, Point,
+		Data.AcceptanceRadius, bSegment, Data.PathRequest);
+
+	if (Status == EStateTreeRunStatus::Succeeded) {
+		++Data.Index;
+	}
+	Data.bOnRoute = Status == EStateTreeRunStatus::Succeeded;
+	return Status;
+}
+
+EStateTreeRunStatus FPlaygroundPatrolTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const {
+	FInstanceDataType& Data = Context.GetInstanceData(*this);
+	FVector Point;
+
+	if (!GetPatrolPoint(Data.Route, Data.Index, Point)) {
+		return EStateTreeRunStatus::Failed;
+	}
+
+	const EStateTreeRunStatus Status = PollRequestedMove(Data.Controller, Point, Data.AcceptanceRadius, Data.PathRequest);
+	if (Status == EStateTreeRunStatus::Succeeded) {
+		++Data.Index;
+	}
+	if (Status != EStateTreeRunStatus::Running) {
+		Data.bOnRoute = Status == EStateTreeRunStatus::Succeeded;
+	}
+	return Status;
+}
+
+void FPlaygroundPatrolTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const {
+	FInstanceDataType& Data = Context.GetInstanceData(*this);
+
+	// Interrupted mid leg, the pawn is no longer at a route point.
+	if (Data.PathRequest != 0 || (Data.Controller && Data.Controller->GetMoveStatus() != EPathFollowingStatus::Idle)) {
+		Data.bOnRoute = false;
+	}
+
+	// An abandoned request's result expires in the path request service.
+	Data.PathRequest = 0;
+	StopMove(Data.Controller);
+}
+
+EStateTreeRunStatus FPlaygroundMoveToTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const {
+	FInstanceDataType& Data = Context.GetInstanceData(*this);
+	Data.PathRequest = 0;
+	return RequestMove(Data.Controller, nullptr, Data.Destination, Data.AcceptanceRadius, false, Data.PathRequest);
+}
+
+EStateTreeRunStatus FPlaygroundMoveToTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const {
+	FInstanceDataType& Data = Context.GetInstanceData(*this);
+	return PollRequestedMove(Data.Controller, Data.Destination, Data.AcceptanceRadius, Data.PathRequest);
+}
+
+void FPlaygroundMoveToTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const {
+	FInstanceDataType& Data = Context.GetInstanceData(*this);
+	Data.PathRequest = 0;
+	StopMove(Data.Controller);
+}
+
+EStateTreeRunStatus FPlaygroundChaseTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const {
+	FInstanceDataType& Data = Context.GetInstanceData(*this);
+
+	if (Data.Controller == nullptr || Data.Target == nullptr) {
+		return EStateTreeRunStatus::Failed;
+	}
+
+	// Goal actor moves are tracked by path following, no need to repath here.
+	switch (Data.Controller->MoveToActor(Data.Target, Data.AcceptanceRadius)) {
+		case EPathFollowingRequestResult::AlreadyAtGoal:
+			return EStateTreeRunStatus::Succeeded;
+		case EPathFollowingRequestResult::RequestSuccessful:
+			return EStateTreeRunStatus::Running;
+		default:
+			return EStateTreeRunStatus::Failed;
+	}
+}
+
+EStateTreeRunStatus FPlaygroundChaseTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const {
+	FInstanceDataType& Data = Context.GetInstanceData(*this);
+
+	if (Data.Controller == nullptr || Data.Controller->GetPawn() == nullptr || !IsValid(Data.Target)) {
+		return EStateTreeRunStatus::Failed;
+	}
+
+	const float Distance = FVector::Dist(Data.Controller->GetPawn()->GetActorLocation(), Data.Target->GetActorLocation());
+	if (Data.LoseRadius > 0.0f && Distance > Data.LoseRadius) {
+		return EStateTreeRunStatus::Failed;
+	}
+
+	// MoveToActor stops on overlap with the target, so its collision counts towards the reach.
+	return PollMove(Data.Controller, Data.Target->GetActorLocation(), Data.AcceptanceRadius, Data.Target->GetSimpleCollisionRadius());
+}
+
+void FPlaygroundChaseTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const {
+	StopMove(Context.GetInstanceData(*this).Controller);
+}
+
+void FPlaygroundHostileEvaluator::TreeStart(FStateTreeExecutionContext& Context) const {
+	FInstanceDataType& Data = Context.GetInstanceData(*this);
+	Data.Target = nullptr;
+	Data.bHasTarget = false;
+}
+
+void FPlaygroundHostileEvaluator::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const {
+	FInstanceDataType& Data = Context.GetInstanceData(*this);
+	auto Factions = UWorld::GetSubsystem<UFactionSubsystem>(Context.GetWorld());
+
+	Data.Target = Factions ? Factions->FindNearestHostile(Data.Actor, Data.Radius) : nullptr;
+	Data.bHasTarget = Data.Target != nullptr;
+}
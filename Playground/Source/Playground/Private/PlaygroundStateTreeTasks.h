@@ -0,0 +1,166 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StateTreeTaskBase.h"
+#include "StateTreeEvaluatorBase.h"
+#include "PlaygroundStateTreeTasks.generated.h"
+
+class AAIController;
+
+/**
+ * Native replacements for the Blueprint tasks of ST_Enemy. Instance data only holds object pointers and
+ * scalars so each node stays a few dozen bytes in the StateTree instance storage.
+ */
+
+USTRUCT()
+struct FPlaygroundPatrolTaskInstanceData
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, Category = "Context")
+	TObjectPtr<AAIController> Controller = nullptr;
+
+	/** Actor with a spline component, whose points are visited in order. **/
+	UPROPERTY(EditAnywhere, Category = "Input")
+	TObjectPtr<AActor> Route = nullptr;
+
+	UPROPERTY(EditAnywhere, Category = "Parameter")
+	float AcceptanceRadius = 50.0f;
+
+	/** Point moved to next, only advanced once it's reached. **/
+	UPROPERTY(VisibleAnywhere, Category = "Output")
+	int32 Index = 0;
+
+	// Pending UPathRequestSubsystem request, 0 once moving.
+	uint32 PathRequest = 0;
+	// Whether the pawn is at the previous point, making the next leg a cacheable route segment.
+	bool bOnRoute = false;
+};
+
+/**
+ * Moves to the next point of a patrol route. Succeeds when the point is reached and fails without
+ * advancing if the move fails, so an interrupted patrol resumes at the same point. Legs between route
+ * points are pathed through UPathRequestSubsystem's cache, shared by every NPC on the route.
+ */
+USTRUCT(meta = (DisplayName = "Playground Patrol"))
+struct FPlaygroundPatrolTask : public FStateTreeTaskCommonBase
+{
+	GENERATED_BODY()
+
+	using FInstanceDataType = FPlaygroundPatrolTaskInstanceData;
+
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+	virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+	virtual EStateTreeRunStatus Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const override;
+	virtual void ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+};
+
+USTRUCT()
+struct FPlaygroundMoveToTaskInstanceData
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, Category = "Context")
+	TObjectPtr<AAIController> Controller = nullptr;
+
+	UPROPERTY(EditAnywhere, Category = "Input")
+	FVector Destination = FVector::ZeroVector;
+
+	UPROPERTY(EditAnywhere, Category = "Parameter")
+	float AcceptanceRadius = 50.0f;
+
+	// Pending UPathRequestSubsystem request, 0 once moving.
+	uint32 PathRequest = 0;
+};
+
+/**
+ * Moves to a location, succeeding on arrival and failing if no path is found or the move is aborted.
+ * The path is found asynchronously.
+ */
+USTRUCT(meta = (DisplayName = "Playground Move To"))
+struct FPlaygroundMoveToTask : public FStateTreeTaskCommonBase
+{
+	GENERATED_BODY()
+
+	using FInstanceDataType = FPlaygroundMoveToTaskInstanceData;
+
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+	virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+	virtual EStateTreeRunStatus Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const override;
+	virtual void ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+};
+
+USTRUCT()
+struct FPlaygroundChaseTaskInstanceData
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, Category = "Context")
+	TObjectPtr<AAIController> Controller = nullptr;
+
+	UPROPERTY(EditAnywhere, Category = "Input")
+	TObjectPtr<AActor> Target = nullptr;
+
+	/** Distance to the target at which the chase succeeds. **/
+	UPROPERTY(EditAnywhere, Category = "Parameter")
+	float AcceptanceRadius = 150.0f;
+
+	/** Distance to the target at which the chase gives up, 0 to never give up. **/
+	UPROPERTY(EditAnywhere, Category = "Parameter")
+	float LoseRadius = 4000.0f;
+};
+
+/**
+ * Follows a moving target until within AcceptanceRadius. Fails if the target is lost or unreachable.
+ */
+USTRUCT(meta = (DisplayName = "Playground Chase"))
+struct FPlaygroundChaseTask : public FStateTreeTaskCommonBase
+{
+	GENERATED_BODY()
+
+	using FInstanceDataType = FPlaygroundChaseTaskInstanceData;
+
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+	virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+	virtual EStateTreeRunStatus Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const override;
+	virtual void ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+};
+
+USTRUCT()
+struct FPlaygroundHostileEvaluatorInstanceData
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, Category = "Context")
+	TObjectPtr<AActor> Actor = nullptr;
+
+	UPROPERTY(EditAnywhere, Category = "Parameter")
+	float Radius = 2000.0f;
+
+	UPROPERTY(VisibleAnywhere, Category = "Output")
+	TObjectPtr<AActor> Target = nullptr;
+
+	UPROPERTY(VisibleAnywhere, Category = "Output")
+	bool bHasTarget = false;
+};
+
+/**
+ * Exposes the nearest actor hostile to the context actor, see UFactionSubsystem::FindNearestHostile.
+ */
+USTRUCT(meta = (DisplayName = "Playground Nearest Hostile"))
+struct FPlaygroundHostileEvaluator : public FStateTreeEvaluatorCommonBase
+{
+	GENERATED_BODY()
+
+	using FInstanceDataType = FPlaygroundHostileEvaluatorInstanceData;
+
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+	virtual void TreeStart(FStateTreeExecutionContext& Context) const override;
+	virtual void Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const override;
+};
@@ -2,4 +2,58 @@
 
 
 #include "PlaygroundStatics.h"
+#include "UObject/UnrealType.h"
+
+bool UPlaygroundStatics::CallBlueprintFunction(UObject* Target, FName Name, TFunctionRef<void(FProperty* Param, void* Params)> SetParam) {
+	UFunction* Function = Target && !Name.IsNone() ? Target->FindFunction(Name) : nullptr;
+	if (Function == nullptr) {
+		return false;
+	}
+
+	uint8* Params = (uint8*) FMemory_Alloca(FMath::Max<int32>(Function->ParmsSize, 1));
+	FMemory::Memzero(Params, Function->ParmsSize);
+
+	for (TFieldIterator<FProperty> It(Function); It && It->HasAnyPropertyFlags(CPF_Parm); ++It) {
+		It->InitializeValue_InContainer(Params);
+
+		if (!It->HasAnyPropertyFlags(CPF_ReturnParm | CPF_OutParm)) {
+			SetParam(*It, Params);
+		}
+	}
+
+	Target->ProcessEvent(Function, Params);
+
+	for (TFieldIterator<FProperty> It(Function); It && It->HasAnyPropertyFlags(CPF_Parm); ++It) {
+		It->DestroyValue_InContainer(Params);
+	}
+
+	return true;
+}
+
+bool UPlaygroundStatics::CallBlueprintFunction(UObject* Target, FName Name, UObject* Argument) {
+	return CallBlueprintFunction(Target, Name, [Argument](FProperty* Param, void* Params) {
+		if (Argument == nullptr) {
+			return;
+		}
+
+		if (auto Object = CastField<FObjectPropertyBase>(Param)) {
+			if (Argument->IsA(Object->PropertyClass)) {
+				Object->SetObjectPropertyValue_InContainer(Params, Argument);
+			}
+		} else if (auto Interface = CastField<FInterfaceProperty>(Param)) {
+			if (Argument->GetClass()->ImplementsInterface(Interface->InterfaceClass)) {
+				Interface->SetPropertyValue_InContainer(Params,
+					FScriptInterface(Argument, Argument->GetInterfaceAddress(Interface->InterfaceClass)));
+			}
+		}
+	});
+}
+
+bool UPlaygroundStatics::CallBlueprintFunctionWithBool(UObject* Target, FName Name, bool bValue) {
+	return CallBlueprintFunction(Target, Name, [bValue](FProperty* Param, void* Params) {
+		if (auto Bool = CastField<FBoolProperty>(Param)) {
+			Bool->SetPropertyValue_InContainer(Params, bValue);
+		}
+	});
+}
 
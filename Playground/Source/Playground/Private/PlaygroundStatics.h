@@ -7,6 +7,8 @@
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "PlaygroundStatics.generated.h"
 
+class FProperty;
+
 UENUM(BlueprintType)
 enum class ECastAnimationID : uint8 {
 	FIREBALL           UMETA(DisplayName = "Fireball"),    
@@ -68,4 +70,18 @@ UCLASS()
 class UPlaygroundStatics : public UBlueprintFunctionLibrary
 {
 	GENERATED_BODY()
+
+public:
+	/**
+	 * Calls a Blueprint function (usually an interface event) on Target by name. Every input parameter is
+	 * default initialized and then handed to SetParam with the parameter buffer to fill in. Returns false if
+	 * Target has no such function.
+	 **/
+	static bool CallBlueprintFunction(UObject* Target, FName Name, TFunctionRef<void(FProperty* Param, void* Params)> SetParam);
+
+	/** Calls a Blueprint function by name, passing Argument to every object or interface parameter it fits. **/
+	static bool CallBlueprintFunction(UObject* Target, FName Name, UObject* Argument);
+
+	/** Calls a Blueprint function by name, passing bValue to its bool parameters. **/
+	static bool CallBlueprintFunctionWithBool(UObject* Target, FName Name, bool bValue);
 };
@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "Poolable.generated.h"
+
+UINTERFACE(MinimalAPI, Blueprintable)
+class UPoolable : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Reset hooks for actors handed out by USpellPoolSubsystem. Pooled actors are hidden and have collision
+ * and ticking disabled while they wait in the pool; anything else has to be reset here.
+ */
+class IPoolable
+{
+	GENERATED_BODY()
+
+public:
+	/** Called when the actor is taken from the pool, after it has been moved into place. **/
+	UFUNCTION(BlueprintNativeEvent, Category = "Pooling")
+	void OnPoolAcquired();
+
+	/** Called when the actor goes back into the pool, use instead of cleanup in Destroyed. **/
+	UFUNCTION(BlueprintNativeEvent, Category = "Pooling")
+	void OnPoolReleased();
+};
@@ -0,0 +1,264 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ProceduralGrassStreamer.h"
+#include "Async/Async.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "LandscapeProxy.h"
+#include "LandscapeLayerInfoObject.h"
+
+DECLARE_STATS_GROUP(TEXT("ProceduralGrass"), STATGROUP_ProceduralGrass, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Snapshot"), STAT_GrassSnapshot, STATGROUP_ProceduralGrass);
+DECLARE_CYCLE_STAT(TEXT("Build"), STAT_GrassBuild, STATGROUP_ProceduralGrass);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Instances"), STAT_GrassInstances, STATGROUP_ProceduralGrass);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Tiles"), STAT_GrassTiles, STATGROUP_ProceduralGrass);
+
+AProceduralGrassStreamer::AProceduralGrassStreamer() {
+	this->PrimaryActorTick.bCanEverTick = true;
+	this->RootComponent = this->CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+bool AProceduralGrassStreamer::GetViewLocation(FVector& Out) const {
+	if (auto Camera = UGameplayStatics::GetPlayerCameraManager(this, 0)) {
+		Out = Camera->GetCameraLocation();
+		return true;
+	} else if (auto Pawn = UGameplayStatics::GetPlayerPawn(this, 0)) {
+		Out = Pawn->GetActorLocation();
+		return true;
+	}
+	return false;
+}
+
+FGrassTileInput AProceduralGrassStreamer::Snapshot(const FIntPoint& Tile) const {
+	SCOPE_CYCLE_COUNTER(STAT_GrassSnapshot);
+
+	FGrassTileInput Input;
+	Input.Tile = Tile;
+	Input.TileSize = this->TileSize;
+	Input.Resolution = this->TileResolution;
+	Input.Density = this->BladesPerTile;
+	Input.Seed = GrassTileGenerator::TileSeed(this->Seed, Tile);
+	Input.MinHeight = this->MinBladeHeight;
+	Input.MaxHeight = this->MaxBladeHeight;
+	Input.Fill(0.0f, 0.0f);
+
+	if (this->Landscape == nullptr || this->LayerInfo == nullptr) {
+		return Input;
+	}
+
+	// Landscape queries aren't thread safe, so sample a coarse grid here and interpolate off thread.
+	const FVector2D Origin = Input.GetOrigin();
+	const float Step = this->TileSize / (this->TileResolution - 1);
+	TArray<uint8> LayerCache;
+
+	for (int32 Y = 0; Y < this->TileResolution; ++Y) {
+		for (int32 X = 0; X < this->TileResolution; ++X) {
+			const FVector Location(Origin.X + X * Step, Origin.Y + Y * Step, 0.0f);
+			const int32 Index = Y * this->TileResolution + X;
+
+			if (TOptional<float> Height = this->Landscape->GetHeightAtLocation(Location)) {
+				Input.Heights[Index] = Height.GetValue();
+				Input.Weights[Index] = this->SampleWeight(Location, LayerCache);
+			}
+		}
+	}
+
+	return Input;
+}
+
+float AProceduralGrassStreamer::SampleWeight(const FVector& Location, TArray<uint8>& LayerCache) const {
+	if (this->BakedWeights.Num() > 0) {
+		const int32 X = FMath::RoundToInt(Location.X / this->BakedSpacing) - this->BakedOrigin.X;
+		const int32 Y = FMath::RoundToInt(Location.Y / this->BakedSpacing) - this->BakedOrigin.Y;
+
+		if (X < 0 || Y < 0 || X >= this->BakedSize.X || Y >= this->BakedSize.Y) {
+			return 0.0f;
+		}
+		return this->BakedWeights[Y * this->BakedSize.X + X] / 255.0f;
+	}
+
+	#if WITH_EDITOR
+		return this->Landscape->GetLayerWeightAtLocation(Location, this->LayerInfo, &LayerCache);
+	#else
+		return 0.0f;
+	#endif
+}
+
+void AProceduralGrassStreamer::BakeLayerWeights() {
+	#if WITH_EDITOR
+		this->BakedWeights.Reset();
+		this->BakedSize = FIntPoint::ZeroValue;
+
+		if (this->Landscape == nullptr || this->LayerInfo == nullptr) {
+			return;
+		}
+
+		// Bake at the tile sample spacing, finer detail would be interpolated away anyway.
+		this->BakedSpacing = this->TileSize / (this->TileResolution - 1);
+		const FBox Bounds = this->Landscape->GetComponentsBoundingBox();
+		const FIntPoint Min(FMath::FloorToInt(Bounds.Min.X / this->BakedSpacing), FMath::FloorToInt(Bounds.Min.Y / this->BakedSpacing));
+		const FIntPoint Max(FMath::CeilToInt(Bounds.Max.X / this->BakedSpacing), FMath::CeilToInt(Bounds.Max.Y / this->BakedSpacing));
+
+		this->Modify();
+		this->BakedOrigin = Min;
+		this->BakedSize = Max - Min + FIntPoint(1, 1);
+		this->BakedWeights.SetNumZeroed(this->BakedSize.X * this->BakedSize.Y);
+
+		TArray<uint8> LayerCache;
+		for (int32 Y = 0; Y < this->BakedSize.Y; ++Y) {
+			for (int32 X = 0; X < this->BakedSize.X; ++X) {
+				const FVector Location((Min.X + X) * this->BakedSpacing, (Min.Y + Y) * this->BakedSpacing, 0.0f);
+				const float Weight = this->Landscape->GetLayerWeightAtLocation(Location, this->LayerInfo, &LayerCache);
+				this->BakedWeights[Y * this->BakedSize.X + X] = (uint8) FMath::RoundToInt(FMath::Clamp(Weight, 0.0f, 1.0f) * 255.0f);
+			}
+		}
+	#endif
+}
+
+void AProceduralGrassStreamer::Launch(const FIntPoint& Tile) {
+	this->Pending.Add(Tile, Async(EAsyncExecution::ThreadPool, [Input = this->Snapshot(Tile)]() {
+		TArray<FGrassBlade> Blades;
+		Blades.Reserve(Input.Density);
+		GrassTileGenerator::Generate(Input, Blades);
+		return Blades;
+	}));
+}
+
+void AProceduralGrassStreamer::Build(const FIntPoint& Tile, const TArray<FGrassBlade>& Blades) {
+	SCOPE_CYCLE_COUNTER(STAT_GrassBuild);
+
+	// Trim to the budget left, the generator can't know about tiles finishing alongside it.
+	const int32 Count = FMath::Min(Blades.Num(), FMath::Max(0, this->InstanceBudget - this->InstanceCount));
+	FGrassTile& Entry = this->Tiles.Add(Tile);
+
+	if (Count == 0 || this->BladeMesh == nullptr) {
+		return;
+	}
+
+	auto Component = NewObject<UInstancedStaticMeshComponent>(this);
+	Component->SetStaticMesh(this->BladeMesh);
+	Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Component->SetCanEverAffectNavigation(false);
+	Component->SetNumCustomDataFloats(FGrassBlade::CUSTOM_DATA_FLOATS);
+	Component->SetupAttachment(this->RootComponent);
+	Component->RegisterComponent();
+
+	TArray<FTransform> Transforms;
+	Transforms.Reserve(Count);
+	for (int32 i = 0; i < Count; ++i) {
+		const FGrassBlade& Blade = Blades[i];
+		Transforms.Emplace(FRotator(0.0f, FMath::RadiansToDegrees(Blade.Facing), 0.0f), FVector(Blade.Position));
+	}
+	Component->AddInstances(Transforms, false, true);
+
+	// Custom data is written in bulk rather than per instance to avoid a render state update each.
+	float* Data = Component->PerInstanceSMCustomData.GetData();
+	for (int32 i = 0; i < Count; ++i, Data += FGrassBlade::CUSTOM_DATA_FLOATS) {
+		const FGrassBlade& Blade = Blades[i];
+		Data[0] = Blade.Height;
+		Data[1] = Blade.Stiffness;
+		Data[2] = Blade.Control1.X;
+		Data[3] = Blade.Control1.Y;
+		Data[4] = Blade.Control2.X;
+		Data[5] = Blade.Control2.Y;
+	}
+	Component->MarkRenderStateDirty();
+
+	Entry.Component = Component;
+	Entry.Count = Count;
+	this->InstanceCount += Count;
+}
+
+void AProceduralGrassStreamer::Drop(const FIntPoint& Tile) {
+	FGrassTile Entry;
+	if (this->Tiles.RemoveAndCopyValue(Tile, Entry)) {
+		if (Entry.Component) {
+			Entry.Component->DestroyComponent();
+		}
+		this->InstanceCount -= Entry.Count;
+	}
+}
+
+void AProceduralGrassStreamer::Tick(float DeltaSeconds) {
+	Super::Tick(DeltaSeconds);
+
+	FVector View;
+	if (!this->GetViewLocation(View)) {
+		return;
+	}
+
+	const FIntPoint Center(FMath::FloorToInt(View.X / this->TileSize), FMath::FloorToInt(View.Y / this->TileSize));
+	const int32 Keep = this->RingRadius + this->UnloadMargin;
+	auto Outside = [&Center](const FIntPoint& Tile, int32 Radius) {
+		const FIntPoint D = Tile - Center;
+		return D.X * D.X + D.Y * D.Y > Radius * Radius;
+	};
+
+	// Finished tiles that left the ring while generating are thrown away.
+	for (auto It = this->Pending.CreateIterator(); It; ++It) {
+		if (It.Value().IsReady()) {
+			const TArray<FGrassBlade> Blades = It.Value().Get();
+			if (!Outside(It.Key(), Keep)) {
+				this->Build(It.Key(), Blades);
+			}
+			It.RemoveCurrent();
+		}
+	}
+
+	TArray<FIntPoint> Dropped;
+	for (const auto& Pair : this->Tiles) {
+		if (Outside(Pair.Key, Keep)) {
+			Dropped.Add(Pair.Key);
+		}
+	}
+	for (const FIntPoint& Tile : Dropped) {
+		this->Drop(Tile);
+	}
+
+	TArray<FIntPoint> Wanted;
+	for (int32 Y = -this->RingRadius; Y <= this->RingRadius; ++Y) {
+		for (int32 X = -this->RingRadius; X <= this->RingRadius; ++X) {
+			const FIntPoint Tile = Center + FIntPoint(X, Y);
+			if (!Outside(Tile, this->RingRadius) && !this->Tiles.Contains(Tile) && !this->Pending.Contains(Tile)) {
+				Wanted.Add(Tile);
+			}
+		}
+	}
+
+	Wanted.Sort([&Center](const FIntPoint& A, const FIntPoint& B) {
+		return (A - Center).SizeSquared() < (B - Center).SizeSquared();
+	});
+
+	// Pending tiles may grow up to BladesPerTile each, reserve that much of the budget for them.
+	int32 Reserved = this->InstanceCount + this->Pending.Num() * this->BladesPerTile;
+	for (const FIntPoint& Tile : Wanted) {
+		if (this->Pending.Num() >= this->MaxTilesInFlight || Reserved + this->BladesPerTile > this->InstanceBudget) {
+			break;
+		}
+		this->Launch(Tile);
+		Reserved += this->BladesPerTile;
+	}
+
+	SET_DWORD_STAT(STAT_GrassInstances, this->InstanceCount);
+	SET_DWORD_STAT(STAT_GrassTiles, this->Tiles.Num());
+}
+
+void AProceduralGrassStreamer::Regenerate() {
+	TArray<FIntPoint> Loaded;
+	this->Tiles.GetKeys(Loaded);
+	for (const FIntPoint& Tile : Loaded) {
+		this->Drop(Tile);
+	}
+}
+
+void AProceduralGrassStreamer::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	// Generation captures its input by value, waiting only keeps the thread pool from outliving the world.
+	for (auto& Pair : this->Pending) {
+		Pair.Value.Wait();
+	}
+	this->Pending.Reset();
+	this->Regenerate();
+
+	Super::EndPlay(EndPlayReason);
+}
@@ -0,0 +1,131 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Async/Future.h"
+#include "GrassTileGenerator.h"
+#include "ProceduralGrassStreamer.generated.h"
+
+class ALandscapeProxy;
+class ULandscapeLayerInfoObject;
+class UInstancedStaticMeshComponent;
+
+USTRUCT()
+struct FGrassTile
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(Transient)
+	TObjectPtr<UInstancedStaticMeshComponent> Component = nullptr;
+
+	int32 Count = 0;
+};
+
+/**
+ * Streams procedural bezier grass (M_ProceduralGrass) around the player. The landscape is split into
+ * square tiles; tiles within RingRadius of the player's tile are generated on the thread pool from the
+ * weights of LayerInfo (Grass_LayerInfo, baked with BakeLayerWeights) and turned into an instanced
+ * component per tile, tiles beyond
+ * RingRadius + UnloadMargin are dropped. Each tile is seeded from Seed and its coordinates, so a tile
+ * always regrows the same blades, and the total instance count never exceeds InstanceBudget.
+ */
+UCLASS()
+class AProceduralGrassStreamer : public AActor
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	TMap<FIntPoint, FGrassTile> Tiles;
+
+	TMap<FIntPoint, TFuture<TArray<FGrassBlade>>> Pending;
+	int32 InstanceCount = 0;
+
+	// Layer weights baked in the editor, weightmaps have no CPU copy in cooked builds.
+	UPROPERTY()
+	TArray<uint8> BakedWeights;
+
+	UPROPERTY()
+	FIntPoint BakedOrigin = FIntPoint::ZeroValue;
+
+	UPROPERTY()
+	FIntPoint BakedSize = FIntPoint::ZeroValue;
+
+	UPROPERTY()
+	float BakedSpacing = 0.0f;
+
+public:
+	UPROPERTY(EditAnywhere, Category = "Grass")
+	TObjectPtr<ALandscapeProxy> Landscape;
+
+	UPROPERTY(EditAnywhere, Category = "Grass")
+	TObjectPtr<ULandscapeLayerInfoObject> LayerInfo;
+
+	UPROPERTY(EditAnywhere, Category = "Grass")
+	TObjectPtr<UStaticMesh> BladeMesh;
+
+	UPROPERTY(EditAnywhere, Category = "Grass", meta = (ClampMin = "100"))
+	float TileSize = 2000.0f;
+
+	/** Height and weight samples per tile edge taken from the landscape. **/
+	UPROPERTY(EditAnywhere, Category = "Grass", meta = (ClampMin = "2", ClampMax = "65"))
+	int32 TileResolution = 9;
+
+	/** Candidate blades per tile, at full layer weight all of them grow. **/
+	UPROPERTY(EditAnywhere, Category = "Grass", meta = (ClampMin = "0"))
+	int32 BladesPerTile = 4000;
+
+	/** Radius in tiles around the player's tile that grows grass. **/
+	UPROPERTY(EditAnywhere, Category = "Grass", meta = (ClampMin = "0"))
+	int32 RingRadius = 3;
+
+	/** Extra tiles a tile has to be beyond RingRadius before it's dropped. **/
+	UPROPERTY(EditAnywhere, Category = "Grass", meta = (ClampMin = "0"))
+	int32 UnloadMargin = 1;
+
+	UPROPERTY(EditAnywhere, Category = "Grass", meta = (ClampMin = "0"))
+	int32 InstanceBudget = 250000;
+
+	UPROPERTY(EditAnywhere, Category = "Grass", meta = (ClampMin = "1"))
+	int32 MaxTilesInFlight = 4;
+
+	UPROPERTY(EditAnywhere, Category = "Grass")
+	int32 Seed = 0;
+
+	UPROPERTY(EditAnywhere, Category = "Grass")
+	float MinBladeHeight = 40.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Grass")
+	float MaxBladeHeight = 80.0f;
+
+	AProceduralGrassStreamer();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	UFUNCTION(BlueprintPure, Category = "Grass")
+	int32 GetInstanceCount() const { return this->InstanceCount; }
+
+	UFUNCTION(BlueprintPure, Category = "Grass")
+	int32 GetTileCount() const { return this->Tiles.Num(); }
+
+	/** Drops every tile, they regrow on the next tick. **/
+	UFUNCTION(BlueprintCallable, Category = "Grass")
+	void Regenerate();
+
+	/** Samples LayerInfo over the whole landscape into the actor, required for grass in cooked builds. **/
+	UFUNCTION(CallInEditor, Category = "Grass")
+	void BakeLayerWeights();
+
+protected:
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	FGrassTileInput Snapshot(const FIntPoint& Tile) const;
+	float SampleWeight(const FVector& Location, TArray<uint8>& LayerCache) const;
+	void Launch(const FIntPoint& Tile);
+	void Build(const FIntPoint& Tile, const TArray<FGrassBlade>& Blades);
+	void Drop(const FIntPoint& Tile);
+	bool GetViewLocation(FVector& Out) const;
+};
@@ -0,0 +1,191 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SpellAssetSubsystem.h"
+#include "Engine/AssetManager.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Misc/CoreDelegates.h"
+
+void USpellAssetSubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+	Super::Initialize(Collection);
+
+	if (!this->SpellTable.IsNull()) {
+		this->TableHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+			this->SpellTable.ToSoftObjectPath(),
+			FStreamableDelegate::CreateUObject(this, &USpellAssetSubsystem::OnTableLoaded));
+	}
+
+	this->TrimHandle = FCoreDelegates::GetMemoryTrimDelegate().AddUObject(this, &USpellAssetSubsystem::TrimUnequipped);
+}
+
+void USpellAssetSubsystem::Deinitialize() {
+	FCoreDelegates::GetMemoryTrimDelegate().Remove(this->TrimHandle);
+
+	for (auto& Pair : this->Spells) {
+		if (Pair.Value.Handle.IsValid()) {
+			Pair.Value.Handle->CancelHandle();
+		}
+	}
+	this->Spells.Empty();
+
+	if (this->TableHandle.IsValid()) {
+		this->TableHandle->CancelHandle();
+		this->TableHandle.Reset();
+	}
+	this->Compiled.Reset();
+
+	Super::Deinitialize();
+}
+
+void USpellAssetSubsystem::OnTableLoaded() {
+	this->LoadedTable = this->SpellTable.Get();
+	if (this->LoadedTable != nullptr) {
+		this->Compiled.Build(*this->LoadedTable);
+	}
+
+	for (FName Spell : this->PendingSpells) {
+		if (FSpellAssets* Assets = this->Spells.Find(Spell)) {
+			this->StreamSpell(Spell, *Assets);
+		}
+	}
+	this->PendingSpells.Empty();
+}
+
+const FSpellData* USpellAssetSubsystem::FindSpell(FName Spell) const {
+	if (this->LoadedTable == nullptr) {
+		return nullptr;
+	}
+	return this->LoadedTable->FindRow<FSpellData>(Spell, TEXT("SpellAssetSubsystem"), false);
+}
+
+float USpellAssetSubsystem::GetSpellCastTime(FSpellHandle Handle) const {
+	return this->Compiled.IsValid(Handle) ? this->Compiled.Get(Handle).CastTime : 0.0f;
+}
+
+TSubclassOf<AActor> USpellAssetSubsystem::GetSpellClass(FSpellHandle Handle) const {
+	return this->Compiled.IsValid(Handle) ? this->Compiled.Get(Handle).SpellClass : nullptr;
+}
+
+void USpellAssetSubsystem::GetSpellScaling(FSpellHandle Handle, float& Fire, float& Sharp) const {
+	if (this->Compiled.IsValid(Handle)) {
+		const FSpellScaling& Scaling = this->Compiled.GetScaling(Handle);
+		Fire = Scaling.Fire;
+		Sharp = Scaling.Sharp;
+	} else {
+		Fire = 0.0f;
+		Sharp = 0.0f;
+	}
+}
+
+void USpellAssetSubsystem::RequestSpellAssets(FName Spell) {
+	FSpellAssets& Assets = this->Spells.FindOrAdd(Spell);
+	if (Assets.bStreamed || Assets.bFailed) {
+		return;
+	}
+
+	if (this->LoadedTable == nullptr) {
+		this->PendingSpells.AddUnique(Spell);
+	} else {
+		this->StreamSpell(Spell, Assets);
+	}
+}
+
+void USpellAssetSubsystem::SetEquippedSpells(const TArray<FName>& Equipped) {
+	for (auto& Pair : this->Spells) {
+		Pair.Value.bEquipped = false;
+	}
+
+	for (FName Spell : Equipped) {
+		this->RequestSpellAssets(Spell);
+		this->Spells.FindChecked(Spell).bEquipped = true;
+	}
+}
+
+void USpellAssetSubsystem::ReleaseSpellAssets(FName Spell) {
+	if (FSpellAssets* Assets = this->Spells.Find(Spell)) {
+		if (Assets->Handle.IsValid()) {
+			Assets->Handle->ReleaseHandle();
+		}
+		this->Spells.Remove(Spell);
+	}
+	this->PendingSpells.Remove(Spell);
+}
+
+ESpellAssetState USpellAssetSubsystem::GetSpellAssetState(FName Spell) const {
+	const FSpellAssets* Assets = this->Spells.Find(Spell);
+	if (Assets == nullptr) {
+		return ESpellAssetState::UNLOADED;
+	}
+	if (Assets->bFailed) {
+		return ESpellAssetState::FAILED;
+	}
+	if (!Assets->bStreamed) {
+		// Waiting on the table.
+		return ESpellAssetState::LOADING;
+	}
+	if (Assets->Handle.IsValid() && !Assets->Handle->HasLoadCompleted()) {
+		return ESpellAssetState::LOADING;
+	}
+	return ESpellAssetState::LOADED;
+}
+
+void USpellAssetSubsystem::TrimUnequipped() {
+	TArray<FName> Unequipped;
+	for (const auto& Pair : this->Spells) {
+		if (!Pair.Value.bEquipped) {
+			Unequipped.Add(Pair.Key);
+		}
+	}
+
+	for (FName Spell : Unequipped) {
+		this->ReleaseSpellAssets(Spell);
+	}
+}
+
+void USpellAssetSubsystem::StreamSpell(FName Spell, FSpellAssets& Assets) {
+	const FSpellData* Data = this->FindSpell(Spell);
+	if (Data == nullptr) {
+		UE_LOG(LogTemp, Warning, TEXT("SpellAssetSubsystem: No spell named %s in %s."), *Spell.ToString(), *this->SpellTable.ToString());
+		Assets.bFailed = true;
+		return;
+	}
+
+	Assets.bStreamed = true;
+
+	TArray<FSoftObjectPath> Paths;
+	if (!Data->SpellBookIcon.IsNull()) {
+		Paths.Add(Data->SpellBookIcon.ToSoftObjectPath());
+	}
+	if (Data->SpellClass != nullptr) {
+		// The class itself is hard referenced by the table, but what it references softly (VFX) is not.
+		this->GatherDependencies(FSoftObjectPath(Data->SpellClass.Get()), Paths);
+	}
+
+	if (Paths.Num() > 0) {
+		Assets.Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+			Paths, FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority);
+	}
+}
+
+void USpellAssetSubsystem::GatherDependencies(const FSoftObjectPath& Asset, TArray<FSoftObjectPath>& Out) const {
+	IAssetRegistry* Registry = IAssetRegistry::Get();
+	if (Registry == nullptr) {
+		return;
+	}
+
+	TArray<FName> Dependencies;
+	Registry->GetDependencies(Asset.GetLongPackageFName(), Dependencies, UE::AssetRegistry::EDependencyCategory::Package);
+
+	TArray<FAssetData> Found;
+	for (FName Package : Dependencies) {
+		if (!Package.ToString().StartsWith(TEXT("/Game/"))) {
+			continue;
+		}
+
+		Found.Reset();
+		Registry->GetAssetsByPackageName(Package, Found);
+		for (const FAssetData& Data : Found) {
+			Out.AddUnique(Data.GetSoftObjectPath());
+		}
+	}
+}
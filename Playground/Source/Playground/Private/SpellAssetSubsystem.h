@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "Engine/StreamableManager.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "PlaygroundStatics.h"
+#include "CompiledSpellTable.h"
+#include "SpellAssetSubsystem.generated.h"
+
+UENUM(BlueprintType)
+enum class ESpellAssetState : uint8 {
+	UNLOADED       UMETA(DisplayName = "Unloaded"),
+	LOADING        UMETA(DisplayName = "Loading"),
+	LOADED         UMETA(DisplayName = "Loaded"),
+	FAILED         UMETA(DisplayName = "Failed"),
+};
+
+/**
+ * Streams the assets a spell needs (spellbook icon, spell class and the packages the spell class
+ * depends on, such as its VFX) asynchronously when the spell is picked up or equipped, so casting or
+ * opening the spellbook never waits on a synchronous load. Assets of spells that aren't equipped are
+ * released when the platform asks to trim memory.
+ */
+UCLASS(Config=Game)
+class USpellAssetSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+	/** Spell DataTable whose rows are FSpellData. **/
+	UPROPERTY(Config)
+	TSoftObjectPtr<UDataTable> SpellTable;
+
+	UPROPERTY(Transient)
+	TObjectPtr<UDataTable> LoadedTable;
+
+	TSharedPtr<FStreamableHandle> TableHandle;
+
+	FCompiledSpellTable Compiled;
+
+	struct FSpellAssets {
+		// Null when the spell had nothing left to stream.
+		TSharedPtr<FStreamableHandle> Handle;
+		bool bStreamed = false;
+		// The spell has no row in the table, so there is nothing to stream.
+		bool bFailed = false;
+		bool bEquipped = false;
+	};
+
+	TMap<FName, FSpellAssets> Spells;
+
+	// Requests made before the table finished loading.
+	TArray<FName> PendingSpells;
+
+	FDelegateHandle TrimHandle;
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Starts streaming the assets of a spell, e.g. when it is picked up. **/
+	UFUNCTION(BlueprintCallable, Category = "Spells")
+	void RequestSpellAssets(FName Spell);
+
+	/** Marks the given spells as equipped, streaming their assets and protecting them from trimming. **/
+	UFUNCTION(BlueprintCallable, Category = "Spells")
+	void SetEquippedSpells(const TArray<FName>& Equipped);
+
+	UFUNCTION(BlueprintCallable, Category = "Spells")
+	void ReleaseSpellAssets(FName Spell);
+
+	UFUNCTION(BlueprintPure, Category = "Spells")
+	ESpellAssetState GetSpellAssetState(FName Spell) const;
+
+	UFUNCTION(BlueprintPure, Category = "Spells")
+	bool IsSpellReady(FName Spell) const { return this->GetSpellAssetState(Spell) == ESpellAssetState::LOADED; }
+
+	/** The spell table, or null while it is still streaming. **/
+	UFUNCTION(BlueprintPure, Category = "Spells")
+	UDataTable* GetSpellTable() const { return this->LoadedTable; }
+
+	const FSpellData* FindSpell(FName Spell) const;
+
+	/** Resolves a spell row to a handle into the compiled table. Invalid while the table is loading. **/
+	UFUNCTION(BlueprintPure, Category = "Spells")
+	FSpellHandle FindSpellHandle(FName Spell) const { return this->Compiled.Find(Spell); }
+
+	UFUNCTION(BlueprintPure, Category = "Spells")
+	bool IsValidSpellHandle(FSpellHandle Handle) const { return this->Compiled.IsValid(Handle); }
+
+	UFUNCTION(BlueprintPure, Category = "Spells")
+	float GetSpellCastTime(FSpellHandle Handle) const;
+
+	UFUNCTION(BlueprintPure, Category = "Spells")
+	TSubclassOf<AActor> GetSpellClass(FSpellHandle Handle) const;
+
+	/** Fire and sharp scaling of a spell, see FScalingData. **/
+	UFUNCTION(BlueprintPure, Category = "Spells")
+	void GetSpellScaling(FSpellHandle Handle, float& Fire, float& Sharp) const;
+
+	FORCEINLINE const FCompiledSpellTable& GetCompiledTable() const { return this->Compiled; }
+
+	/** Releases the assets of every spell that isn't equipped. **/
+	void TrimUnequipped();
+
+private:
+	void OnTableLoaded();
+	void StreamSpell(FName Spell, FSpellAssets& Assets);
+	void GatherDependencies(const FSoftObjectPath& Asset, TArray<FSoftObjectPath>& Out) const;
+};
@@ -0,0 +1,370 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SpellDamageBatch.h"
+#include "BatchDamageable.h"
+#include "StatComponent.h"
+#include "SpellAssetSubsystem.h"
+#include "PlaygroundStatics.h"
+#include "Engine/World.h"
+#include "Engine/GameInstance.h"
+#include "Math/VectorRegister.h"
+#include "Kismet/GameplayStatics.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UnrealType.h"
+
+DECLARE_STATS_GROUP(TEXT("SpellDamage"), STATGROUP_SpellDamage, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Evaluate"), STAT_SpellDamageEvaluate, STATGROUP_SpellDamage);
+DECLARE_CYCLE_STAT(TEXT("Dispatch"), STAT_SpellDamageDispatch, STATGROUP_SpellDamage);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Targets"), STAT_SpellDamageTargets, STATGROUP_SpellDamage);
+
+constexpr int32 LANES = 4;
+
+static const TCHAR* DAMAGEABLE_CLASS = TEXT("/Game/Assets/Interface/BPI_Damageable.BPI_Damageable_C");
+static const TCHAR* HIT_CLASS = TEXT("/Game/Assets/Statistics/BP_HitOperator.BP_HitOperator_C");
+
+/** Hit instance for BPI_Damageable's Take Damage carrying Amount, spawned like BB_BaseHurtBox does. **/
+static UObject* NewHitInstance(UClass* HitClass, UObject* Outer, float Amount) {
+	if (HitClass == nullptr) {
+		return nullptr;
+	}
+
+	UObject* Hit = NewObject<UObject>(Outer, HitClass);
+	if (auto Damage = FindFProperty<FNumericProperty>(HitClass, TEXT("Damage"))) {
+		void* Value = Damage->ContainerPtrToValuePtr<void>(Hit);
+		if (Damage->IsFloatingPoint()) {
+			Damage->SetFloatingPointPropertyValue(Value, Amount);
+		} else {
+			Damage->SetIntPropertyValue(Value, (int64) FMath::RoundToInt(Amount));
+		}
+	}
+
+	return Hit;
+}
+
+void FSpellDamageBatch::Reset() {
+	this->Targets.Reset();
+	this->X.Reset();
+	this->Y.Reset();
+	this->Z.Reset();
+	this->FireResist.Reset();
+	this->SharpResist.Reset();
+	this->Damage.Reset();
+}
+
+void FSpellDamageBatch::Reserve(int32 Count) {
+	const int32 Padded = Align(Count, LANES);
+	this->Targets.Reserve(Count);
+	this->X.Reserve(Padded);
+	this->Y.Reserve(Padded);
+	this->Z.Reserve(Padded);
+	this->FireResist.Reserve(Padded);
+	this->SharpResist.Reserve(Padded);
+	this->Damage.Reserve(Padded);
+}
+
+void FSpellDamageBatch::Add(AActor* Target) {
+	if (Target == nullptr) {
+		return;
+	}
+
+	FVector2D Resist = FVector2D::ZeroVector;
+	if (Target->Implements<UBatchDamageable>()) {
+		Resist = IBatchDamageable::Execute_GetDamageResistance(Target);
+	}
+
+	this->Add(Target, Target->GetActorLocation(), Resist.X, Resist.Y);
+}
+
+void FSpellDamageBatch::Add(AActor* Target, const FVector& Location, float InFireResist, float InSharpResist) {
+	this->Targets.Add(Target);
+	this->X.Add(Location.X);
+	this->Y.Add(Location.Y);
+	this->Z.Add(Location.Z);
+	this->FireResist.Add(FMath::Clamp(InFireResist, 0.0f, 1.0f));
+	this->SharpResist.Add(FMath::Clamp(InSharpResist, 0.0f, 1.0f));
+}
+
+void FSpellDamageBatch::Pad() {
+	const int32 Count = this->Targets.Num();
+	const int32 Padded = Align(Count, LANES);
+
+	this->X.SetNumUninitialized(Count);
+	this->Y.SetNumUninitialized(Count);
+	this->Z.SetNumUninitialized(Count);
+	this->FireResist.SetNumUninitialized(Count);
+	this->SharpResist.SetNumUninitialized(Count);
+
+	for (int32 i = Count; i < Padded; ++i) {
+		this->X.Add(MAX_flt);
+		this->Y.Add(MAX_flt);
+		this->Z.Add(MAX_flt);
+		this->FireResist.Add(1.0f);
+		this->SharpResist.Add(1.0f);
+	}
+
+	this->Damage.SetNumUninitialized(Padded);
+}
+
+void FSpellDamageBatch::Evaluate(const FSpellDamageEvent& Event) {
+	SCOPE_CYCLE_COUNTER(STAT_SpellDamageEvaluate);
+	this->Pad();
+
+	const VectorRegister4Float Zero = VectorZeroFloat();
+	const VectorRegister4Float One = VectorOneFloat();
+	const VectorRegister4Float OriginX = VectorSetFloat1(Event.Origin.X);
+	const VectorRegister4Float OriginY = VectorSetFloat1(Event.Origin.Y);
+	const VectorRegister4Float OriginZ = VectorSetFloat1(Event.Origin.Z);
+	const VectorRegister4Float RadiusSquared = VectorSetFloat1(Event.Radius * Event.Radius);
+	const VectorRegister4Float NegInvRadius = VectorSetFloat1(Event.Radius > 0.0f ? -1.0f / Event.Radius : 0.0f);
+	const VectorRegister4Float MinFalloff = VectorSetFloat1(Event.MinFalloff);
+	const VectorRegister4Float Fire = VectorSetFloat1(Event.BaseDamage * Event.Scaling.Fire);
+	const VectorRegister4Float Sharp = VectorSetFloat1(Event.BaseDamage * Event.Scaling.Sharp);
+
+	const int32 Padded = this->Damage.Num();
+	for (int32 i = 0; i < Padded; i += LANES) {
+		const VectorRegister4Float DX = VectorSubtract(VectorLoad(&this->X[i]), OriginX);
+		const VectorRegister4Float DY = VectorSubtract(VectorLoad(&this->Y[i]), OriginY);
+		const VectorRegister4Float DZ = VectorSubtract(VectorLoad(&this->Z[i]), OriginZ);
+		const VectorRegister4Float DistSquared = VectorMultiplyAdd(DX, DX, VectorMultiplyAdd(DY, DY, VectorMultiply(DZ, DZ)));
+
+		const VectorRegister4Float Falloff = VectorMax(
+			MinFalloff,
+			VectorMultiplyAdd(VectorSqrt(DistSquared), NegInvRadius, One));
+
+		const VectorRegister4Float Scaled = VectorMultiplyAdd(
+			Fire, VectorSubtract(One, VectorLoad(&this->FireResist[i])),
+			VectorMultiply(Sharp, VectorSubtract(One, VectorLoad(&this->SharpResist[i]))));
+
+		const VectorRegister4Float InRange = VectorCompareLE(DistSquared, RadiusSquared);
+		VectorStore(VectorSelect(InRange, VectorMultiply(Scaled, Falloff), Zero), &this->Damage[i]);
+	}
+}
+
+void FSpellDamageBatch::EvaluateScalar(const FSpellDamageEvent& Event) {
+	SCOPE_CYCLE_COUNTER(STAT_SpellDamageEvaluate);
+	this->Pad();
+
+	const float RadiusSquared = Event.Radius * Event.Radius;
+	const float InvRadius = Event.Radius > 0.0f ? 1.0f / Event.Radius : 0.0f;
+
+	for (int32 i = 0; i < this->Damage.Num(); ++i) {
+		const FVector Location(this->X[i], this->Y[i], this->Z[i]);
+		const float DistSquared = FVector::DistSquared(Location, Event.Origin);
+
+		if (DistSquared > RadiusSquared) {
+			this->Damage[i] = 0.0f;
+			continue;
+		}
+
+		const float Falloff = FMath::Max(Event.MinFalloff, 1.0f - FMath::Sqrt(DistSquared) * InvRadius);
+		const float Scaled = Event.BaseDamage * (
+			Event.Scaling.Fire * (1.0f - this->FireResist[i]) +
+			Event.Scaling.Sharp * (1.0f - this->SharpResist[i]));
+
+		this->Damage[i] = Scaled * Falloff;
+	}
+}
+
+int32 FSpellDamageBatch::Dispatch(AActor* DamageCauser, AController* Instigator) const {
+	SCOPE_CYCLE_COUNTER(STAT_SpellDamageDispatch);
+	INC_DWORD_STAT_BY(STAT_SpellDamageTargets, this->Targets.Num());
+
+	static const FName TakeDamage(TEXT("Take Damage"));
+	UClass* Damageable = LoadClass<UInterface>(nullptr, DAMAGEABLE_CLASS);
+	UClass* HitClass = Damageable ? LoadClass<UObject>(nullptr, HIT_CLASS) : nullptr;
+
+	int32 Damaged = 0;
+
+	for (int32 i = 0; i < this->Targets.Num(); ++i) {
+		AActor* Target = this->Targets[i];
+		const float Amount = this->Damage[i];
+
+		if (Target == nullptr || Amount <= 0.0f) {
+			continue;
+		}
+
+		if (Target->Implements<UBatchDamageable>()) {
+			IBatchDamageable::Execute_ReceiveBatchedDamage(Target, Amount, DamageCauser, Instigator);
+		} else if (Damageable && Target->GetClass()->ImplementsInterface(Damageable)) {
+			UPlaygroundStatics::CallBlueprintFunction(Target, TakeDamage, NewHitInstance(HitClass, Target, Amount));
+		} else if (auto Stats = Target->FindComponentByClass<UStatComponent>()) {
+			Stats->QueueChange(EPlaygroundStat::HEALTH, -Amount);
+		} else {
+			UGameplayStatics::ApplyDamage(Target, Amount, Instigator, DamageCauser, nullptr);
+		}
+
+		++Damaged;
+	}
+
+	return Damaged;
+}
+
+int32 USpellDamageStatics::ApplySpellAreaDamage(UObject* WorldContextObject, FSpellHandle Spell, float BaseDamage, FVector Origin, float Radius, const TArray<AActor*>& Targets, AActor* DamageCauser,
+	AController* Instigator, float MinFalloff)
+{
+	UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+	UGameInstance* Instance = World ? World->GetGameInstance() : nullptr;
+	USpellAssetSubsystem* Spells = Instance ? Instance->GetSubsystem<USpellAssetSubsystem>() : nullptr;
+
+	if (Spells == nullptr || !Spells->IsValidSpellHandle(Spell)) {
+		return 0;
+	}
+
+	FSpellDamageEvent Event;
+	Event.Origin = Origin;
+	Event.Radius = Radius;
+	Event.BaseDamage = BaseDamage;
+	Event.MinFalloff = MinFalloff;
+	Event.Scaling = Spells->GetCompiledTable().GetScaling(Spell);
+
+	// Reused across hits so they don't reallocate the buffers. Damage is dealt on the game thread only.
+	static FSpellDamageBatch Shared;
+	static bool bSharedInUse = false;
+
+	// A target reacting to the damage may cast another area spell, which then gets a batch of its own.
+	FSpellDamageBatch Nested;
+	FSpellDamageBatch& Batch = bSharedInUse ? Nested : Shared;
+	TGuardValue<bool> InUse(bSharedInUse, true);
+
+	Batch.Reset();
+	Batch.Reserve(Targets.Num());
+	for (AActor* Target : Targets) {
+		Batch.Add(Target);
+	}
+
+	Batch.Evaluate(Event);
+	const int32 Damaged = Batch.Dispatch(DamageCauser, Instigator);
+	Batch.Reset();
+
+	return Damaged;
+}
+
+/**
+ * Spawns targets of a class implementing BPI_Damageable around the origin of the current world and times
+ * one area hit on them both ways: the per target path, computing each target's damage on its own and
+ * calling BPI_Damageable's Take Damage with a hit instance like BB_BaseHurtBox does, and FSpellDamageBatch
+ * end to end, which ends in the same Take Damage calls, with Add and Dispatch broken out from the
+ * evaluation. Also checks the SIMD and per target kernels agree. The targets are destroyed afterwards.
+ *
+ * Usage: Playground.BenchmarkSpellDamage [Targets] [Iterations] [TargetClass]
+ */
+static void RunSpellDamageBenchmark(const TArray<FString>& Args, UWorld* World) {
+	const int32 Count = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 2000;
+	const int32 Iterations = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 10;
+	const FString ClassPath = Args.Num() > 2
+		? Args[2]
+		: TEXT("/Game/Assets/Actors/Entity/Characters/MainCharacter/BP_PlaygroundCharacter.BP_PlaygroundCharacter_C");
+
+	UClass* Damageable = LoadClass<UInterface>(nullptr, DAMAGEABLE_CLASS);
+	UClass* TargetClass = LoadClass<AActor>(nullptr, *ClassPath);
+	if (World == nullptr || Damageable == nullptr || TargetClass == nullptr || !TargetClass->ImplementsInterface(Damageable)) {
+		UE_LOG(LogTemp, Warning, TEXT("BenchmarkSpellDamage: %s doesn't implement BPI_Damageable."), *ClassPath);
+		return;
+	}
+
+	const FName TakeDamage(TEXT("Take Damage"));
+	UClass* HitClass = LoadClass<UObject>(nullptr, HIT_CLASS);
+
+	FRandomStream Random(Count);
+	FActorSpawnParameters Params;
+	Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	TArray<AActor*> Targets;
+	for (int32 i = 0; i < Count; ++i) {
+		const FTransform Transform(Random.GetPointInBoxWithSize(FVector(4000.0f)));
+		if (AActor* Target = World->SpawnActor<AActor>(TargetClass, Transform, Params)) {
+			Targets.Add(Target);
+		}
+	}
+
+	FSpellDamageEvent Event;
+	Event.Radius = 1500.0f;
+	Event.BaseDamage = 50.0f;
+	Event.MinFalloff = 0.25f;
+	Event.Scaling = { 1.5f, 0.5f };
+
+	const float RadiusSquared = Event.Radius * Event.Radius;
+	const float InvRadius = 1.0f / Event.Radius;
+
+	double BlueprintTime = 0.0;
+	for (int32 i = 0; i < Iterations; ++i) {
+		const double Start = FPlatformTime::Seconds();
+		for (AActor* Target : Targets) {
+			if (!IsValid(Target)) {
+				continue;
+			}
+
+			// Same damage and call as the batch, one target at a time.
+			const float DistSquared = FVector::DistSquared(Target->GetActorLocation(), Event.Origin);
+			if (DistSquared > RadiusSquared) {
+				continue;
+			}
+
+			const float Falloff = FMath::Max(Event.MinFalloff, 1.0f - FMath::Sqrt(DistSquared) * InvRadius);
+			const float Amount = Event.BaseDamage * (Event.Scaling.Fire + Event.Scaling.Sharp) * Falloff;
+			UPlaygroundStatics::CallBlueprintFunction(Target, TakeDamage, NewHitInstance(HitClass, Target, Amount));
+		}
+		BlueprintTime += FPlatformTime::Seconds() - Start;
+	}
+
+	FSpellDamageBatch Batch;
+	double AddTime = 0.0;
+	double EvaluateTime = 0.0;
+	double DispatchTime = 0.0;
+	for (int32 i = 0; i < Iterations; ++i) {
+		double Start = FPlatformTime::Seconds();
+		Batch.Reset();
+		Batch.Reserve(Targets.Num());
+		for (AActor* Target : Targets) {
+			if (IsValid(Target)) {
+				Batch.Add(Target);
+			}
+		}
+		AddTime += FPlatformTime::Seconds() - Start;
+
+		Start = FPlatformTime::Seconds();
+		Batch.Evaluate(Event);
+		EvaluateTime += FPlatformTime::Seconds() - Start;
+
+		Start = FPlatformTime::Seconds();
+		Batch.Dispatch(nullptr, nullptr);
+		DispatchTime += FPlatformTime::Seconds() - Start;
+	}
+
+	// Kernel check on the last batch.
+	TArray<float> Simd;
+	for (int32 i = 0; i < Batch.Num(); ++i) {
+		Simd.Add(Batch.GetDamage(i));
+	}
+	double Start = FPlatformTime::Seconds();
+	Batch.EvaluateScalar(Event);
+	const double ScalarTime = FPlatformTime::Seconds() - Start;
+
+	int32 Mismatches = 0;
+	for (int32 i = 0; i < Batch.Num(); ++i) {
+		if (!FMath::IsNearlyEqual(Simd[i], Batch.GetDamage(i), 1e-2f)) {
+			++Mismatches;
+		}
+	}
+
+	const double PerTarget = 1e9 / FMath::Max(1.0, Targets.Num() * (double) Iterations);
+	UE_LOG(LogTemp, Log, TEXT("BenchmarkSpellDamage: %d %s targets, blueprint %.2f ns/target, batch %.2f ns/target (add %.2f, evaluate %.2f, dispatch %.2f)"),
+		Targets.Num(), *TargetClass->GetName(),
+		BlueprintTime * PerTarget,
+		(AddTime + EvaluateTime + DispatchTime) * PerTarget,
+		AddTime * PerTarget, EvaluateTime * PerTarget, DispatchTime * PerTarget);
+	UE_LOG(LogTemp, Log, TEXT("BenchmarkSpellDamage: per target evaluate %.2f ns/target, %d mismatches against simd"),
+		ScalarTime * 1e9 / FMath::Max(1, Batch.Num()), Mismatches);
+
+	for (AActor* Target : Targets) {
+		if (IsValid(Target)) {
+			Target->Destroy();
+		}
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GBenchmarkSpellDamageCommand(
+	TEXT("Playground.BenchmarkSpellDamage"),
+	TEXT("Compares per target Blueprint damage with batched area damage. Args: [Targets] [Iterations] [TargetClass]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunSpellDamageBenchmark));
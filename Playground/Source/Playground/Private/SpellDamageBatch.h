@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CompiledSpellTable.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "SpellDamageBatch.generated.h"
+
+/**
+ * Parameters of one spell hit, shared by every target in the batch.
+ */
+struct FSpellDamageEvent
+{
+	FVector Origin = FVector::ZeroVector;
+	float Radius = 0.0f;
+	float BaseDamage = 0.0f;
+	// Damage multiplier at the edge of the radius, falling off linearly from 1 at the origin.
+	float MinFalloff = 0.0f;
+	FSpellScaling Scaling = { 0.0f, 0.0f };
+};
+
+/**
+ * Collects every target of one area spell hit into structure of arrays buffers, evaluates damage over
+ * them four targets at a time and dispatches the results in a single pass. Damage of a target is
+ *
+ *     BaseDamage * (Fire * (1 - FireResist) + Sharp * (1 - SharpResist)) * Falloff
+ *
+ * and targets outside Radius take none. Reuse one batch across hits to avoid reallocating the buffers.
+ */
+class FSpellDamageBatch
+{
+public:
+	void Reset();
+	void Reserve(int32 Count);
+
+	/** Adds a target, reading resistances through IBatchDamageable when implemented. **/
+	void Add(AActor* Target);
+	/** Adds a target with explicit location and resistances. Target may be null for synthetic runs. **/
+	void Add(AActor* Target, const FVector& Location, float FireResist, float SharpResist);
+
+	/** Fills the damage buffer with SIMD kernels. **/
+	void Evaluate(const FSpellDamageEvent& Event);
+	/** Per target reference of Evaluate, used to check and benchmark it. **/
+	void EvaluateScalar(const FSpellDamageEvent& Event);
+
+	/**
+	 * Sends non zero damage to each target, through IBatchDamageable, BPI_Damageable's Take Damage with a
+	 * BP_HitOperator hit instance, a UStatComponent or, failing those, the engine's ApplyDamage. Returns the
+	 * number of targets damaged.
+	 **/
+	int32 Dispatch(AActor* DamageCauser, AController* Instigator) const;
+
+	FORCEINLINE int32 Num() const { return this->Targets.Num(); }
+	FORCEINLINE float GetDamage(int32 Index) const { return this->Damage[Index]; }
+
+private:
+	TArray<AActor*> Targets;
+
+	// Sized to a multiple of 4, padding lanes sit at infinity and take no damage.
+	TArray<float> X;
+	TArray<float> Y;
+	TArray<float> Z;
+	TArray<float> FireResist;
+	TArray<float> SharpResist;
+	TArray<float> Damage;
+
+	void Pad();
+};
+
+UCLASS()
+class USpellDamageStatics : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Damages every target of an area spell hit in one batch, scaled by the spell's FScalingData.
+	 * Returns the number of targets damaged.
+	 **/
+	UFUNCTION(BlueprintCallable, Category = "Spells", meta = (WorldContext = "WorldContextObject", AdvancedDisplay = "MinFalloff"))
+	static int32 ApplySpellAreaDamage(UObject* WorldContextObject, FSpellHandle Spell, float BaseDamage,
+		FVector Origin, float Radius, const TArray<AActor*>& Targets, AActor* DamageCauser, AController* Instigator,
+		float MinFalloff = 0.0f);
+};
@@ -0,0 +1,206 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SpellPoolSubsystem.h"
+#include "Engine/World.h"
+#include "Engine/GameInstance.h"
+#include "TimerManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Poolable.h"
+#include "SpellAssetSubsystem.h"
+
+DECLARE_STATS_GROUP(TEXT("SpellPool"), STATGROUP_SpellPool, STATCAT_Advanced);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pool Hits"), STAT_SpellPoolHits, STATGROUP_SpellPool);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pool Misses"), STAT_SpellPoolMisses, STATGROUP_SpellPool);
+
+AActor* USpellPoolSubsystem::SpawnInactive(UClass* Class, FSpellPool& Pool) {
+	FActorSpawnParameters Params;
+	Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	AActor* Actor = this->GetWorld()->SpawnActor<AActor>(Class, FTransform::Identity, Params);
+	if (Actor != nullptr) {
+		Actor->OnDestroyed.AddDynamic(this, &USpellPoolSubsystem::OnPooledActorDestroyed);
+		this->Deactivate(Actor);
+		Pool.Stats.PeakSize = FMath::Max(Pool.Stats.PeakSize, Pool.InUse + Pool.Free.Num() + 1);
+	}
+	return Actor;
+}
+
+void USpellPoolSubsystem::Activate(AActor* Actor) {
+	Actor->SetActorHiddenInGame(false);
+	Actor->SetActorEnableCollision(true);
+	Actor->SetActorTickEnabled(true);
+
+	TInlineComponentArray<UActorComponent*> Components(Actor);
+	for (UActorComponent* Component : Components) {
+		if (Component->bAutoActivate) {
+			// Restarts components that were running when spawned, e.g. projectile movement or VFX.
+			Component->Activate(true);
+		} else if (Component->PrimaryComponentTick.bCanEverTick && Component->PrimaryComponentTick.bStartWithTickEnabled) {
+			Component->SetComponentTickEnabled(true);
+		}
+	}
+}
+
+void USpellPoolSubsystem::Deactivate(AActor* Actor) {
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+
+	// Component ticks are separate from the actor's, so e.g. projectile movement would keep moving the
+	// pooled actor.
+	TInlineComponentArray<UActorComponent*> Components(Actor);
+	for (UActorComponent* Component : Components) {
+		Component->Deactivate();
+		Component->SetComponentTickEnabled(false);
+	}
+}
+
+void USpellPoolSubsystem::Prewarm(TSubclassOf<AActor> Class, int32 Count) {
+	if (Class == nullptr) {
+		return;
+	}
+
+	FSpellPool& Pool = this->Pools.FindOrAdd(Class);
+	while (Pool.Free.Num() < Count) {
+		AActor* Actor = this->SpawnInactive(Class, Pool);
+		if (Actor == nullptr) {
+			break;
+		}
+		Pool.Free.Add(Actor);
+	}
+}
+
+void USpellPoolSubsystem::PrewarmEquipped(const TArray<FName>& Spells) {
+	auto Instance = this->GetWorld()->GetGameInstance();
+	auto Assets = Instance ? Instance->GetSubsystem<USpellAssetSubsystem>() : nullptr;
+	if (Assets == nullptr) {
+		return;
+	}
+
+	for (FName Spell : Spells) {
+		if (const FSpellData* Data = Assets->FindSpell(Spell)) {
+			this->Prewarm(Data->SpellClass, this->PrewarmCount);
+		}
+	}
+}
+
+AActor* USpellPoolSubsystem::Acquire(TSubclassOf<AActor> Class, const FTransform& Transform, AActor* Owner, APawn* Instigator, float Lifetime) {
+	if (Class == nullptr) {
+		return nullptr;
+	}
+
+	FSpellPool& Pool = this->Pools.FindOrAdd(Class);
+	AActor* Actor = nullptr;
+
+	// Pooled actors may have been destroyed by something else, e.g. a level unload.
+	while (Pool.Free.Num() > 0 && Actor == nullptr) {
+		AActor* Candidate = Pool.Free.Pop(false);
+		if (IsValid(Candidate)) {
+			Actor = Candidate;
+		}
+	}
+
+	if (Actor != nullptr) {
+		Pool.Stats.Hits += 1;
+		INC_DWORD_STAT(STAT_SpellPoolHits);
+	} else {
+		Pool.Stats.Misses += 1;
+		INC_DWORD_STAT(STAT_SpellPoolMisses);
+		Actor = this->SpawnInactive(Class, Pool);
+		if (Actor == nullptr) {
+			return nullptr;
+		}
+	}
+
+	Pool.InUse += 1;
+	this->Active.Add(Actor);
+
+	Actor->SetOwner(Owner);
+	Actor->SetInstigator(Instigator);
+	Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+	this->Activate(Actor);
+
+	if (Actor->Implements<UPoolable>()) {
+		IPoolable::Execute_OnPoolAcquired(Actor);
+	}
+
+	// Looked up again since the hook above may have acquired or released other actors.
+	FTimerHandle* Handle = this->Active.Find(Actor);
+	if (Lifetime > 0.0f && Handle != nullptr) {
+		TWeakObjectPtr<AActor> Weak(Actor);
+		this->GetWorld()->GetTimerManager().SetTimer(*Handle, FTimerDelegate::CreateWeakLambda(this, [this, Weak]() {
+			if (Weak.IsValid()) {
+				this->Release(Weak.Get());
+			}
+		}), Lifetime, false);
+	}
+
+	return Actor;
+}
+
+void USpellPoolSubsystem::Release(AActor* Actor) {
+	if (!IsValid(Actor)) {
+		return;
+	}
+
+	FTimerHandle Handle;
+	if (!this->Active.RemoveAndCopyValue(Actor, Handle)) {
+		// Either already back in its pool, or never pooled; either way not ours to destroy.
+		FSpellPool* Pool = this->Pools.Find(Actor->GetClass());
+		if (Pool == nullptr || !Pool->Free.Contains(Actor)) {
+			UE_LOG(LogTemp, Warning, TEXT("SpellPoolSubsystem: Ignoring release of %s, it wasn't acquired from a pool."), *Actor->GetName());
+		}
+		return;
+	}
+
+	// An early release must not let the lifetime timer release the actor again after it is reacquired.
+	this->GetWorld()->GetTimerManager().ClearTimer(Handle);
+
+	FSpellPool& Pool = this->Pools.FindChecked(Actor->GetClass());
+	Pool.InUse -= 1;
+
+	if (Actor->Implements<UPoolable>()) {
+		IPoolable::Execute_OnPoolReleased(Actor);
+	}
+
+	this->Deactivate(Actor);
+	Pool.Free.Add(Actor);
+}
+
+void USpellPoolSubsystem::OnPooledActorDestroyed(AActor* Actor) {
+	FSpellPool* Pool = this->Pools.Find(Actor->GetClass());
+	if (Pool == nullptr) {
+		return;
+	}
+
+	FTimerHandle Handle;
+	if (this->Active.RemoveAndCopyValue(Actor, Handle)) {
+		this->GetWorld()->GetTimerManager().ClearTimer(Handle);
+		Pool->InUse -= 1;
+	} else {
+		Pool->Free.RemoveSingleSwap(Actor, false);
+	}
+}
+
+FSpellPoolStats USpellPoolSubsystem::GetPoolStats(TSubclassOf<AActor> Class) const {
+	const FSpellPool* Pool = this->Pools.Find(Class.Get());
+	return Pool ? Pool->Stats : FSpellPoolStats();
+}
+
+void USpellPoolSubsystem::LogStats() const {
+	for (const auto& Pair : this->Pools) {
+		const FSpellPool& Pool = Pair.Value;
+		UE_LOG(LogTemp, Log, TEXT("%s: %d hits, %d misses, peak %d, %d in use, %d free"),
+			*GetNameSafe(Pair.Key), Pool.Stats.Hits, Pool.Stats.Misses, Pool.Stats.PeakSize, Pool.InUse, Pool.Free.Num());
+	}
+}
+
+static FAutoConsoleCommandWithWorld GDumpSpellPoolsCommand(
+	TEXT("Playground.DumpSpellPools"),
+	TEXT("Logs hit, miss and peak size counts of every spell pool in the world."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World) {
+		if (auto Subsystem = UWorld::GetSubsystem<USpellPoolSubsystem>(World)) {
+			Subsystem->LogStats();
+		}
+	}));
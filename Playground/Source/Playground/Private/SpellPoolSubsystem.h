@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/TimerHandle.h"
+#include "SpellPoolSubsystem.generated.h"
+
+USTRUCT(BlueprintType)
+struct FSpellPoolStats
+{
+	GENERATED_BODY()
+
+public:
+	/** Acquires served from the pool. **/
+	UPROPERTY(BlueprintReadOnly, Category = "Pooling")
+	int32 Hits = 0;
+
+	/** Acquires that had to spawn a new actor. **/
+	UPROPERTY(BlueprintReadOnly, Category = "Pooling")
+	int32 Misses = 0;
+
+	/** Most actors of this class alive at once, pooled or in use. **/
+	UPROPERTY(BlueprintReadOnly, Category = "Pooling")
+	int32 PeakSize = 0;
+};
+
+USTRUCT()
+struct FSpellPool
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<AActor>> Free;
+
+	int32 InUse = 0;
+	FSpellPoolStats Stats;
+};
+
+/**
+ * Pools spell actors (FSpellData::SpellClass) per class so casting reuses actors instead of spawning
+ * and destroying them. Released actors are hidden with collision, ticking and their components off until
+ * acquired again; classes implementing IPoolable get reset hooks.
+ */
+UCLASS(Config=Game)
+class USpellPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	TMap<TObjectPtr<UClass>, FSpellPool> Pools;
+
+	// Actors currently handed out, so release can tell pooled actors from others, with the timer that
+	// releases them when acquired with a lifetime.
+	UPROPERTY(Transient)
+	TMap<TObjectPtr<AActor>, FTimerHandle> Active;
+
+public:
+	/** Instances spawned per class by PrewarmEquipped. **/
+	UPROPERTY(Config, EditAnywhere, Category = "Pooling")
+	int32 PrewarmCount = 4;
+
+	/** Spawns inactive instances of Class until the pool holds at least Count. **/
+	UFUNCTION(BlueprintCallable, Category = "Pooling")
+	void Prewarm(TSubclassOf<AActor> Class, int32 Count);
+
+	/** Prewarms the spell class of each named spell row, see USpellAssetSubsystem. **/
+	UFUNCTION(BlueprintCallable, Category = "Pooling")
+	void PrewarmEquipped(const TArray<FName>& Spells);
+
+	/**
+	 * Takes an actor of Class from the pool, or spawns one on a miss. When Lifetime is positive the actor
+	 * is released automatically after that many seconds.
+	 **/
+	UFUNCTION(BlueprintCallable, Category = "Pooling", meta = (AdvancedDisplay = "Owner,Instigator,Lifetime"))
+	AActor* Acquire(TSubclassOf<AActor> Class, const FTransform& Transform, AActor* Owner = nullptr,
+		APawn* Instigator = nullptr, float Lifetime = 0.0f);
+
+	/** Returns an actor to its pool. Actors that didn't come from a pool are left alone. **/
+	UFUNCTION(BlueprintCallable, Category = "Pooling")
+	void Release(AActor* Actor);
+
+	UFUNCTION(BlueprintPure, Category = "Pooling")
+	FSpellPoolStats GetPoolStats(TSubclassOf<AActor> Class) const;
+
+	void LogStats() const;
+
+private:
+	AActor* SpawnInactive(UClass* Class, FSpellPool& Pool);
+	void Activate(AActor* Actor);
+	void Deactivate(AActor* Actor);
+
+	/** Forgets pooled actors destroyed by something else, e.g. a spell that still destroys itself on impact. **/
+	UFUNCTION()
+	void OnPooledActorDestroyed(AActor* Actor);
+};
@@ -0,0 +1,148 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "StatBindingSubsystem.h"
+#include "Components/ProgressBar.h"
+#include "Components/TextBlock.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_STATS_GROUP(TEXT("StatBinding"), STATGROUP_StatBinding, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Flush"), STAT_StatBindingFlush, STATGROUP_StatBinding);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Widget Updates"), STAT_StatBindingUpdates, STATGROUP_StatBinding);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Avoided Invalidations"), STAT_StatBindingAvoided, STATGROUP_StatBinding);
+
+void UStatBindingSubsystem::Bind(UStatComponent* Stats, EPlaygroundStat Stat, UWidget* Widget) {
+	if (Stats == nullptr || Widget == nullptr || Stat >= EPlaygroundStat::COUNT) {
+		return;
+	}
+
+	if (!this->Watched.Contains(Stats)) {
+		this->Watched.Add(Stats, Stats->OnStatChangedNative.AddUObject(this, &UStatBindingSubsystem::OnStatChanged));
+	}
+
+	this->Bindings.Add({ Stats, Widget, Stat, 0.0f, 0.0f, true });
+	++this->DirtyCount;
+	++this->Counters.Changes;
+}
+
+void UStatBindingSubsystem::Unbind(UWidget* Widget) {
+	this->Bindings.RemoveAll([Widget](const FBinding& Binding) {
+		return Binding.Widget == Widget;
+	});
+}
+
+void UStatBindingSubsystem::OnStatChanged(UStatComponent* Stats, EPlaygroundStat Stat) {
+	for (FBinding& Binding : this->Bindings) {
+		if (Binding.Stat == Stat && Binding.Stats == Stats) {
+			// Counted per binding, as each one could have been an update of its own.
+			++this->Counters.Changes;
+			if (!Binding.bDirty) {
+				Binding.bDirty = true;
+				++this->DirtyCount;
+			}
+		}
+	}
+}
+
+void UStatBindingSubsystem::Push(UWidget* Widget, EPlaygroundStat Stat, float Current, float Max) {
+	if (auto Bar = Cast<UProgressBar>(Widget)) {
+		Bar->SetPercent(Max > 0.0f ? Current / Max : 0.0f);
+	} else if (auto Text = Cast<UTextBlock>(Widget)) {
+		Text->SetText(FText::AsNumber(FMath::RoundToInt(Current)));
+	} else if (Widget->Implements<UStatBoundWidget>()) {
+		IStatBoundWidget::Execute_OnBoundStatChanged(Widget, Stat, Current, Max);
+	}
+}
+
+void UStatBindingSubsystem::Flush() {
+	SCOPE_CYCLE_COUNTER(STAT_StatBindingFlush);
+
+	const int32 Updates = this->Counters.Updates;
+	bool bStale = false;
+
+	for (FBinding& Binding : this->Bindings) {
+		UStatComponent* Stats = Binding.Stats.Get();
+		UWidget* Widget = Binding.Widget.Get();
+
+		if (Stats == nullptr || Widget == nullptr) {
+			bStale = true;
+			continue;
+		}
+
+		if (!Binding.bDirty) {
+			continue;
+		}
+		Binding.bDirty = false;
+
+		const FStatValue& Value = Stats->GetValue(Binding.Stat);
+		// A change that was undone within the frame, or a fresh binding already showing the value.
+		if (Value.Current == Binding.LastValue && Value.Max == Binding.LastMax && Binding.LastMax != 0.0f) {
+			continue;
+		}
+
+		Binding.LastValue = Value.Current;
+		Binding.LastMax = Value.Max;
+		Push(Widget, Binding.Stat, Value.Current, Value.Max);
+		++this->Counters.Updates;
+	}
+
+	this->DirtyCount = 0;
+	INC_DWORD_STAT_BY(STAT_StatBindingUpdates, this->Counters.Updates - Updates);
+	SET_DWORD_STAT(STAT_StatBindingAvoided, this->Counters.Avoided());
+
+	if (bStale) {
+		this->Bindings.RemoveAll([](const FBinding& Binding) {
+			return !Binding.Stats.IsValid() || !Binding.Widget.IsValid();
+		});
+
+		for (auto It = this->Watched.CreateIterator(); It; ++It) {
+			const TWeakObjectPtr<UStatComponent> Stats = It.Key();
+			const bool bUsed = Stats.IsValid() && this->Bindings.ContainsByPredicate([&Stats](const FBinding& Binding) {
+				return Binding.Stats == Stats;
+			});
+
+			if (!bUsed) {
+				if (Stats.IsValid()) {
+					Stats->OnStatChangedNative.Remove(It.Value());
+				}
+				It.RemoveCurrent();
+			}
+		}
+	}
+}
+
+void UStatBindingSubsystem::Tick(float DeltaTime) {
+	if (this->DirtyCount > 0) {
+		this->Flush();
+	}
+}
+
+void UStatBindingSubsystem::Deinitialize() {
+	for (auto& Pair : this->Watched) {
+		if (Pair.Key.IsValid()) {
+			Pair.Key->OnStatChangedNative.Remove(Pair.Value);
+		}
+	}
+	this->Watched.Reset();
+	this->Bindings.Reset();
+	Super::Deinitialize();
+}
+
+TStatId UStatBindingSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStatBindingSubsystem, STATGROUP_Tickables);
+}
+
+void UStatBindingSubsystem::LogStats() const {
+	UE_LOG(LogTemp, Log, TEXT("StatBinding: %d bindings, %d changes, %d widget updates, %d invalidations avoided"),
+		this->Bindings.Num(), this->Counters.Changes, this->Counters.Updates, this->Counters.Avoided());
+}
+
+static FAutoConsoleCommandWithWorld GDumpStatBindingsCommand(
+	TEXT("Playground.DumpStatBindings"),
+	TEXT("Logs stat changes, widget updates and avoided invalidations of the stat to UI bindings."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World) {
+		if (auto Subsystem = UWorld::GetSubsystem<UStatBindingSubsystem>(World)) {
+			Subsystem->LogStats();
+		}
+	}));
@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/Interface.h"
+#include "StatComponent.h"
+#include "StatBindingSubsystem.generated.h"
+
+class UWidget;
+
+UINTERFACE(MinimalAPI, Blueprintable)
+class UStatBoundWidget : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Widgets bound through UStatBindingSubsystem that aren't a plain progress bar or text block, such as
+ * WBP_SpellMenu or WBP_Inventory, receive the flushed value through this.
+ */
+class IStatBoundWidget
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintNativeEvent, Category = "Stats")
+	void OnBoundStatChanged(EPlaygroundStat Stat, float Current, float Max);
+};
+
+USTRUCT(BlueprintType)
+struct FStatBindingStats
+{
+	GENERATED_BODY()
+
+public:
+	/** Stat changes seen per binding, counting each new binding as one. **/
+	UPROPERTY(BlueprintReadOnly, Category = "Stats")
+	int32 Changes = 0;
+
+	/** Widget updates actually made. **/
+	UPROPERTY(BlueprintReadOnly, Category = "Stats")
+	int32 Updates = 0;
+
+	FORCEINLINE int32 Avoided() const { return this->Changes - this->Updates; }
+};
+
+/**
+ * Pushes stat component values into UMG widgets at most once per frame. A stat change only marks its
+ * bindings dirty; dirty bindings are written to their widgets when the subsystem ticks, after actors
+ * and before Slate paints, and only when the displayed value actually changed. Damage over time or a
+ * multi hit combo therefore invalidates a health bar once per frame instead of once per hit.
+ */
+UCLASS()
+class UStatBindingSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	struct FBinding {
+		TWeakObjectPtr<UStatComponent> Stats;
+		TWeakObjectPtr<UWidget> Widget;
+		EPlaygroundStat Stat;
+		float LastValue;
+		float LastMax;
+		bool bDirty;
+	};
+
+	TArray<FBinding> Bindings;
+	// Components whose OnStatChangedNative we listen to, with their handles.
+	TMap<TWeakObjectPtr<UStatComponent>, FDelegateHandle> Watched;
+	int32 DirtyCount = 0;
+
+	FStatBindingStats Counters;
+
+public:
+	/**
+	 * Binds Stat of Stats to Widget. Progress bars get the stat percent, text blocks the rounded value,
+	 * and widgets implementing IStatBoundWidget get both. The widget is updated on the next flush.
+	 **/
+	UFUNCTION(BlueprintCallable, Category = "Stats")
+	void Bind(UStatComponent* Stats, EPlaygroundStat Stat, UWidget* Widget);
+
+	UFUNCTION(BlueprintCallable, Category = "Stats")
+	void Unbind(UWidget* Widget);
+
+	UFUNCTION(BlueprintPure, Category = "Stats")
+	FStatBindingStats GetBindingStats() const { return this->Counters; }
+
+	/** Writes every dirty binding to its widget. **/
+	void Flush();
+
+	void LogStats() const;
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	void OnStatChanged(UStatComponent* Stats, EPlaygroundStat Stat);
+	static void Push(UWidget* Widget, EPlaygroundStat Stat, float Current, float Max);
+};
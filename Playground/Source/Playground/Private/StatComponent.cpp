@@ -0,0 +1,153 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "StatComponent.h"
+#include "Algo/BinarySearch.h"
+
+DECLARE_STATS_GROUP(TEXT("PlaygroundStats"), STATGROUP_PlaygroundStats, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Modifier Chain"), STAT_StatModifierChain, STATGROUP_PlaygroundStats);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Stat Changes"), STAT_StatChanges, STATGROUP_PlaygroundStats);
+
+UStatComponent::UStatComponent() {
+	// Only ticks while changes are queued.
+	this->PrimaryComponentTick.bCanEverTick = true;
+	this->PrimaryComponentTick.bStartWithTickEnabled = false;
+	this->PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+}
+
+FStatValue& UStatComponent::GetValue(EPlaygroundStat Stat) {
+	return Stat == EPlaygroundStat::MANA ? this->Mana : this->Health;
+}
+
+const FStatValue& UStatComponent::GetValue(EPlaygroundStat Stat) const {
+	return Stat == EPlaygroundStat::MANA ? this->Mana : this->Health;
+}
+
+int32 UStatComponent::AddModifier(const FStatModifier& Modifier) {
+	if (Modifier.Stat >= EPlaygroundStat::COUNT) {
+		return INDEX_NONE;
+	}
+
+	auto& Chain = this->Chains[(int32) Modifier.Stat];
+	const int32 Id = this->NextModifierId++;
+
+	// Insert after every entry of equal or lower priority, keeping the chain sorted and stable.
+	const int32 Index = Algo::UpperBoundBy(Chain, Modifier.Priority,
+		[](const FModifierEntry& Entry) { return Entry.Modifier.Priority; });
+	Chain.Insert({ Modifier, Id }, Index);
+
+	return Id;
+}
+
+bool UStatComponent::RemoveModifier(int32 Id) {
+	for (auto& Chain : this->Chains) {
+		const int32 Index = Chain.IndexOfByPredicate([Id](const FModifierEntry& Entry) { return Entry.Id == Id; });
+		if (Index != INDEX_NONE) {
+			Chain.RemoveAt(Index, 1, false);
+			return true;
+		}
+	}
+	return false;
+}
+
+void UStatComponent::ClearModifiers(EPlaygroundStat Stat) {
+	if (Stat < EPlaygroundStat::COUNT) {
+		this->Chains[(int32) Stat].Reset();
+	}
+}
+
+float UStatComponent::Modify(EPlaygroundStat Stat, float Diff) const {
+	SCOPE_CYCLE_COUNTER(STAT_StatModifierChain);
+
+	for (const FModifierEntry& Entry : this->Chains[(int32) Stat]) {
+		const float Value = Entry.Modifier.Value;
+
+		switch (Entry.Modifier.Operator) {
+			case EStatOperator::ADD:
+				Diff += Value;
+				break;
+			case EStatOperator::MULTIPLY:
+				Diff *= Value;
+				break;
+			case EStatOperator::ABSORB:
+				if (Diff < 0.0f) {
+					Diff = FMath::Min(0.0f, Diff + Value);
+				}
+				break;
+			case EStatOperator::CAP_LOSS:
+				Diff = FMath::Max(Diff, -Value);
+				break;
+			case EStatOperator::CAP_GAIN:
+				Diff = FMath::Min(Diff, Value);
+				break;
+			default:
+				break;
+		}
+	}
+
+	return Diff;
+}
+
+float UStatComponent::ApplyChange(EPlaygroundStat Stat, float Diff) {
+	if (Stat >= EPlaygroundStat::COUNT) {
+		return 0.0f;
+	}
+
+	const float Modified = this->Modify(Stat, Diff);
+	this->Commit(Stat, Modified);
+	return Modified;
+}
+
+void UStatComponent::QueueChange(EPlaygroundStat Stat, float Diff) {
+	if (Stat >= EPlaygroundStat::COUNT) {
+		return;
+	}
+
+	// Modifiers run per change, so caps and absorbs see individual hits rather than their sum.
+	this->Pending[(int32) Stat] += this->Modify(Stat, Diff);
+	this->HasPending[(int32) Stat] = true;
+	this->SetComponentTickEnabled(true);
+}
+
+void UStatComponent::FlushChanges() {
+	for (int32 i = 0; i < (int32) EPlaygroundStat::COUNT; ++i) {
+		if (this->HasPending[i]) {
+			const float Diff = this->Pending[i];
+			this->Pending[i] = 0.0f;
+			this->HasPending[i] = false;
+			this->Commit((EPlaygroundStat) i, Diff);
+		}
+	}
+}
+
+void UStatComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) {
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	// Disabled first so changes queued by listeners during the flush re-enable it for next frame.
+	this->SetComponentTickEnabled(false);
+	this->FlushChanges();
+}
+
+float UStatComponent::GetStatPercent(EPlaygroundStat Stat) const {
+	const FStatValue& Value = this->GetValue(Stat);
+	return Value.Max > 0.0f ? Value.Current / Value.Max : 0.0f;
+}
+
+void UStatComponent::SetStat(EPlaygroundStat Stat, float NewValue) {
+	if (Stat >= EPlaygroundStat::COUNT) {
+		return;
+	}
+
+	this->Commit(Stat, NewValue - this->GetValue(Stat).Current);
+}
+
+void UStatComponent::Commit(EPlaygroundStat Stat, float Diff) {
+	FStatValue& Value = this->GetValue(Stat);
+	const float Old = Value.Current;
+	Value.Current = FMath::Clamp(Old + Diff, 0.0f, Value.Max);
+
+	if (Value.Current != Old) {
+		INC_DWORD_STAT(STAT_StatChanges);
+		this->OnStatChangedNative.Broadcast(this, Stat);
+		this->OnStatChanged.Broadcast(Stat, Old, Value.Current, Value.Current - Old);
+	}
+}
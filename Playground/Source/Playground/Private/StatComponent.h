@@ -0,0 +1,159 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "StatComponent.generated.h"
+
+UENUM(BlueprintType)
+enum class EPlaygroundStat : uint8 {
+	HEALTH             UMETA(DisplayName = "Health"),
+	MANA               UMETA(DisplayName = "Mana"),
+	COUNT              UMETA(Hidden),
+};
+
+/**
+ * Native operators a stat modifier can apply to an incoming change before it reaches the stat.
+ */
+UENUM(BlueprintType)
+enum class EStatOperator : uint8 {
+	/** Adds Value to the change. **/
+	ADD                UMETA(DisplayName = "Add"),
+	/** Multiplies the change by Value. **/
+	MULTIPLY           UMETA(DisplayName = "Multiply"),
+	/** Reduces the magnitude of negative changes by Value, never flipping their sign. **/
+	ABSORB             UMETA(DisplayName = "Absorb"),
+	/** Limits negative changes to at most Value in magnitude. **/
+	CAP_LOSS           UMETA(DisplayName = "Cap Loss"),
+	/** Limits positive changes to at most Value. **/
+	CAP_GAIN           UMETA(DisplayName = "Cap Gain"),
+};
+
+USTRUCT(BlueprintType)
+struct FStatModifier
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stats")
+	EPlaygroundStat Stat = EPlaygroundStat::HEALTH;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stats")
+	EStatOperator Operator = EStatOperator::ADD;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stats")
+	float Value = 0.0f;
+
+	/** Lower priorities run first. Modifiers of equal priority run in the order they were added. **/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stats")
+	int32 Priority = 0;
+};
+
+USTRUCT(BlueprintType)
+struct FStatValue
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stats")
+	float Current = 100.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stats")
+	float Max = 100.0f;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_FourParams(
+	FStatChangeListener,
+	EPlaygroundStat, Stat,
+	float, Old,
+	float, New,
+	float, Diff);
+
+class UStatComponent;
+DECLARE_MULTICAST_DELEGATE_TwoParams(FNativeStatChangeListener, UStatComponent*, EPlaygroundStat);
+
+/**
+ * Health and mana of an actor. Changes run through a pre-change modifier chain before they are applied,
+ * like BP_Health and BP_HitOperator, but the chain is a flat priority sorted array of native operators
+ * so a hit costs no allocation or Blueprint calls. Changes can be applied immediately, or queued and
+ * applied together at the end of the frame with one change event per stat.
+ */
+UCLASS(ClassGroup=(Playground), meta=(BlueprintSpawnableComponent))
+class UStatComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+	struct FModifierEntry {
+		FStatModifier Modifier;
+		int32 Id;
+	};
+
+	// One chain per stat, sorted by priority.
+	TArray<FModifierEntry> Chains[(int32) EPlaygroundStat::COUNT];
+	// Sum of queued changes per stat after their modifiers ran.
+	float Pending[(int32) EPlaygroundStat::COUNT] = { 0 };
+	bool HasPending[(int32) EPlaygroundStat::COUNT] = { false };
+	int32 NextModifierId = 0;
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Stats")
+	FStatValue Health;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Stats")
+	FStatValue Mana;
+
+	UPROPERTY(BlueprintAssignable, Category = "Stats")
+	FStatChangeListener OnStatChanged;
+
+	/** Native counterpart of OnStatChanged, used by UStatBindingSubsystem. **/
+	FNativeStatChangeListener OnStatChangedNative;
+
+	UStatComponent();
+
+	/** Adds a modifier to its stat's chain, returning an id to remove it with. **/
+	UFUNCTION(BlueprintCallable, Category = "Stats")
+	int32 AddModifier(const FStatModifier& Modifier);
+
+	UFUNCTION(BlueprintCallable, Category = "Stats")
+	bool RemoveModifier(int32 Id);
+
+	UFUNCTION(BlueprintCallable, Category = "Stats")
+	void ClearModifiers(EPlaygroundStat Stat);
+
+	/** Runs Diff through the modifier chain and applies it now. Returns the applied change. **/
+	UFUNCTION(BlueprintCallable, Category = "Stats")
+	float ApplyChange(EPlaygroundStat Stat, float Diff);
+
+	/** Runs Diff through the modifier chain and queues it until the end of the frame. **/
+	UFUNCTION(BlueprintCallable, Category = "Stats")
+	void QueueChange(EPlaygroundStat Stat, float Diff);
+
+	/** Applies queued changes now, one change event per stat. **/
+	UFUNCTION(BlueprintCallable, Category = "Stats")
+	void FlushChanges();
+
+	UFUNCTION(BlueprintCallable, Category = "Stats")
+	void ApplyDamage(float Damage) { this->ApplyChange(EPlaygroundStat::HEALTH, -Damage); }
+
+	UFUNCTION(BlueprintPure, Category = "Stats")
+	float GetStat(EPlaygroundStat Stat) const { return this->GetValue(Stat).Current; }
+
+	UFUNCTION(BlueprintPure, Category = "Stats")
+	float GetStatPercent(EPlaygroundStat Stat) const;
+
+	/** Sets a stat directly, bypassing the modifier chain. **/
+	UFUNCTION(BlueprintCallable, Category = "Stats")
+	void SetStat(EPlaygroundStat Stat, float Value);
+
+	/** Runs Diff through the modifier chain of Stat without applying it. **/
+	float Modify(EPlaygroundStat Stat, float Diff) const;
+
+	FStatValue& GetValue(EPlaygroundStat Stat);
+	const FStatValue& GetValue(EPlaygroundStat Stat) const;
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+private:
+	void Commit(EPlaygroundStat Stat, float Diff);
+};
@@ -0,0 +1,329 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "StreamingDirectorSubsystem.h"
+#include "Engine/LevelStreaming.h"
+#include "Engine/LevelStreamingVolume.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "LevelInstance/LevelInstanceActor.h"
+#include "GameFramework/Pawn.h"
+#include "Misc/PackageName.h"
+#include "Misc/App.h"
+#include "Kismet/GameplayStatics.h"
+#include "HAL/IConsoleManager.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+CSV_DEFINE_CATEGORY(PlaygroundStreaming, true);
+
+DECLARE_STATS_GROUP(TEXT("StreamingDirector"), STATGROUP_StreamingDirector, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Update"), STAT_StreamingDirectorUpdate, STATGROUP_StreamingDirector);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Loaded MB"), STAT_StreamingDirectorMemory, STATGROUP_StreamingDirector);
+
+bool UStreamingDirectorSubsystem::FManaged::IsValid() const {
+	return this->Streaming.IsValid() || this->Instance.IsValid();
+}
+
+bool UStreamingDirectorSubsystem::FManaged::IsLoaded() const {
+	if (const ULevelStreaming* Level = this->Streaming.Get()) {
+		return Level->IsLevelLoaded();
+	}
+
+	const ALevelInstance* Actor = this->Instance.Get();
+	return Actor && Actor->IsLoaded();
+}
+
+bool UStreamingDirectorSubsystem::FManaged::IsVisible() const {
+	if (const ULevelStreaming* Level = this->Streaming.Get()) {
+		return Level->IsLevelVisible();
+	}
+
+	// Level instances are added to the world as part of their load.
+	return this->IsLoaded();
+}
+
+bool UStreamingDirectorSubsystem::FManaged::ShouldBeLoaded() const {
+	const ULevelStreaming* Level = this->Streaming.Get();
+	return Level ? Level->ShouldBeLoaded() : this->bWanted;
+}
+
+bool UStreamingDirectorSubsystem::FManaged::IsPending() const {
+	if (const ULevelStreaming* Level = this->Streaming.Get()) {
+		return Level->HasLoadRequestPending()
+			|| Level->IsLevelLoaded() != Level->ShouldBeLoaded()
+			|| Level->IsLevelVisible() != Level->ShouldBeVisible();
+	}
+
+	return this->IsLoaded() != this->bWanted;
+}
+
+void UStreamingDirectorSubsystem::FManaged::RequestLoad() {
+	if (ULevelStreaming* Level = this->Streaming.Get()) {
+		Level->SetShouldBeLoaded(true);
+	} else if (ALevelInstance* Actor = this->Instance.Get()) {
+		Actor->LoadLevelInstance();
+	}
+}
+
+void UStreamingDirectorSubsystem::FManaged::RequestUnload() {
+	if (ULevelStreaming* Level = this->Streaming.Get()) {
+		Level->SetShouldBeVisible(false);
+		Level->SetShouldBeLoaded(false);
+	} else if (ALevelInstance* Actor = this->Instance.Get()) {
+		Actor->UnloadLevelInstance();
+	}
+}
+
+void UStreamingDirectorSubsystem::FManaged::RequestVisible() {
+	ULevelStreaming* Level = this->Streaming.Get();
+	if (Level && Level->IsLevelLoaded() && !Level->ShouldBeVisible()) {
+		Level->SetShouldBeVisible(true);
+	}
+}
+
+void UStreamingDirectorSubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+	Super::Initialize(Collection);
+	this->LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UStreamingDirectorSubsystem::OnLevelAdded);
+}
+
+void UStreamingDirectorSubsystem::Deinitialize() {
+	FWorldDelegates::LevelAddedToWorld.Remove(this->LevelAddedHandle);
+	this->Levels.Reset();
+	Super::Deinitialize();
+}
+
+const FStreamingRegion* UStreamingDirectorSubsystem::FindRegion(const FString& PackageName) const {
+	const FName Name = FName(FPackageName::GetShortName(PackageName));
+	return this->Regions.FindByPredicate([Name](const FStreamingRegion& Region) {
+		return Region.Level == Name;
+	});
+}
+
+void UStreamingDirectorSubsystem::OnWorldBeginPlay(UWorld& InWorld) {
+	Super::OnWorldBeginPlay(InWorld);
+
+	for (ULevelStreaming* Streaming : InWorld.GetStreamingLevels()) {
+		if (Streaming == nullptr) {
+			continue;
+		}
+
+		const FStreamingRegion* Config = this->FindRegion(Streaming->GetWorldAssetPackageName());
+		if (Config == nullptr) {
+			continue;
+		}
+
+		FStreamingRegion Region = *Config;
+		if (!Region.Bounds.IsValid) {
+			for (ALevelStreamingVolume* Volume : Streaming->EditorStreamingVolumes) {
+				if (Volume) {
+					Region.Bounds += Volume->GetComponentsBoundingBox(true);
+				}
+			}
+		}
+
+		if (!Region.Bounds.IsValid) {
+			UE_LOG(LogTemp, Warning, TEXT("StreamingDirector: %s has no bounds or streaming volumes, leaving it alone."), *Region.Level.ToString());
+			continue;
+		}
+
+		// Take over from the streaming volumes, which would otherwise unload what was predicted.
+		Streaming->bDisableDistanceStreaming = true;
+		// Levels already requested, e.g. by the persistent level, count as wanted so they can be unloaded.
+		this->Levels.Add({ Streaming, nullptr, Region, 0.0, 0.0f, Streaming->ShouldBeLoaded(), Streaming->IsLevelLoaded(), Streaming->IsLevelVisible() });
+	}
+
+	for (ULevel* Level : InWorld.GetLevels()) {
+		this->AddInstances(Level);
+	}
+
+	for (const FStreamingRegion& Region : this->Regions) {
+		const bool bFound = this->Levels.ContainsByPredicate([&Region](const FManaged& Managed) {
+			return Managed.Region.Level == Region.Level;
+		});
+
+		if (!bFound) {
+			UE_LOG(LogTemp, Warning, TEXT("StreamingDirector: no sublevel or level instance of %s at begin play, it is only managed once a level instance of it streams in."),
+				*Region.Level.ToString());
+		}
+	}
+}
+
+void UStreamingDirectorSubsystem::AddInstances(ULevel* Level) {
+	if (Level == nullptr) {
+		return;
+	}
+
+	for (AActor* Actor : Level->Actors) {
+		ALevelInstance* Instance = Cast<ALevelInstance>(Actor);
+		if (Instance == nullptr || this->Levels.ContainsByPredicate([Instance](const FManaged& Managed) { return Managed.Instance == Instance; })) {
+			continue;
+		}
+
+		const FStreamingRegion* Config = this->FindRegion(Instance->GetWorldAsset().GetLongPackageName());
+		if (Config == nullptr) {
+			continue;
+		}
+
+		FStreamingRegion Region = *Config;
+		if (!Region.Bounds.IsValid) {
+			Region.Bounds = FBox::BuildAABB(Instance->GetActorLocation(), FVector(this->InstanceExtent));
+		}
+
+		// Instances load themselves once registered, so they start out wanted and are unloaded if far away.
+		const bool bLoaded = Instance->IsLoaded();
+		this->Levels.Add({ nullptr, Instance, Region, 0.0, 0.0f, true, bLoaded, bLoaded });
+	}
+}
+
+void UStreamingDirectorSubsystem::OnLevelAdded(ULevel* Level, UWorld* InWorld) {
+	// World Partition cells bring their level instance actors with them.
+	if (InWorld == this->GetWorld() && InWorld->HasBegunPlay()) {
+		this->AddInstances(Level);
+	}
+}
+
+bool UStreamingDirectorSubsystem::Predict(TArray<FVector>& OutPath) const {
+	const APawn* Pawn = UGameplayStatics::GetPlayerPawn(this->GetWorld(), 0);
+	if (Pawn == nullptr) {
+		return false;
+	}
+
+	const FVector Location = Pawn->GetActorLocation();
+	const FVector Velocity = Pawn->GetVelocity();
+	const FVector Facing = Pawn->GetControlRotation().Vector().GetSafeNormal2D();
+
+	// Samples every half second, with the look ahead growing along the path.
+	const int32 Steps = FMath::Max(1, FMath::CeilToInt(this->PredictionTime / 0.5f));
+	OutPath.Reset(Steps + 1);
+	for (int32 i = 0; i <= Steps; ++i) {
+		const float Alpha = (float) i / Steps;
+		OutPath.Add(Location + Velocity * (this->PredictionTime * Alpha) + Facing * (this->LookAhead * Alpha));
+	}
+
+	return true;
+}
+
+float UStreamingDirectorSubsystem::DistanceToPath(const FBox& Bounds, const TArray<FVector>& Path) {
+	float Best = MAX_flt;
+	for (const FVector& Point : Path) {
+		Best = FMath::Min(Best, (float) Bounds.ComputeSquaredDistanceToPoint(Point));
+	}
+	return FMath::Sqrt(Best);
+}
+
+void UStreamingDirectorSubsystem::Record(EStreamingEvent Event, FName Level, float Value) {
+	if (this->Timeline.Num() >= this->MaxTimelineEntries) {
+		this->Timeline.RemoveAt(0, this->Timeline.Num() - this->MaxTimelineEntries + 1, false);
+	}
+
+	this->Timeline.Add({ FPlatformTime::Seconds(), Event, Level, Value });
+	CSV_EVENT(PlaygroundStreaming, TEXT("%s %s"), *UEnum::GetValueAsString(Event), *Level.ToString());
+}
+
+void UStreamingDirectorSubsystem::Tick(float DeltaTime) {
+	SCOPE_CYCLE_COUNTER(STAT_StreamingDirectorUpdate);
+
+	FString Pending;
+	const double Now = FPlatformTime::Seconds();
+
+	// Level instances go away with their World Partition cell.
+	this->Levels.RemoveAll([](const FManaged& Managed) { return !Managed.IsValid(); });
+
+	// Completions first, so the budget below sees the current state.
+	for (FManaged& Managed : this->Levels) {
+		const bool bLoaded = Managed.IsLoaded();
+		const bool bVisible = Managed.IsVisible();
+
+		if (bLoaded != Managed.bLoaded) {
+			this->Record(bLoaded ? EStreamingEvent::LOADED : EStreamingEvent::UNLOADED, Managed.Region.Level,
+				bLoaded ? (float) ((Now - Managed.RequestTime) * 1000.0) : 0.0f);
+		}
+		if (bVisible != Managed.bVisible) {
+			this->Record(bVisible ? EStreamingEvent::SHOWN : EStreamingEvent::HIDDEN, Managed.Region.Level);
+		}
+
+		Managed.bLoaded = bLoaded;
+		Managed.bVisible = bVisible;
+		if (Managed.IsPending()) {
+			Pending += Managed.Region.Level.ToString() + TEXT(" ");
+		}
+	}
+
+	// DeltaTime is dilated and clamped by the world, hitches are about the real frame time.
+	const float FrameMs = FApp::GetDeltaTime() * 1000.0;
+	if (FrameMs > this->HitchThresholdMs) {
+		this->Record(EStreamingEvent::HITCH, NAME_None, FrameMs);
+		if (!Pending.IsEmpty()) {
+			UE_LOG(LogTemp, Warning, TEXT("StreamingDirector: %.1f ms frame while streaming %s"), FrameMs, *Pending);
+		}
+	}
+
+	TArray<FVector> Path;
+	if (!this->Predict(Path)) {
+		return;
+	}
+
+	// Nearest to the predicted path first, they get the budget.
+	TArray<TPair<float, int32>> Order;
+	for (int32 i = 0; i < this->Levels.Num(); ++i) {
+		Order.Emplace(DistanceToPath(this->Levels[i].Region.Bounds, Path), i);
+	}
+	Order.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key < B.Key; });
+
+	float Memory = 0.0f;
+	for (const auto& Entry : Order) {
+		FManaged& Managed = this->Levels[Entry.Value];
+		const float Distance = Entry.Key;
+		const float Current = FMath::Sqrt(Managed.Region.Bounds.ComputeSquaredDistanceToPoint(Path[0]));
+		const bool bFits = Memory + Managed.Region.MemoryMB <= this->MemoryBudgetMB;
+
+		Managed.AwayTime = Current > this->UnloadDistance ? Managed.AwayTime + DeltaTime : 0.0f;
+
+		if (Distance <= this->LoadDistance && bFits) {
+			if (!Managed.ShouldBeLoaded()) {
+				Managed.RequestTime = Now;
+				this->Record(EStreamingEvent::REQUEST_LOAD, Managed.Region.Level, Distance);
+				Managed.RequestLoad();
+			}
+			Managed.bWanted = true;
+		} else if (Managed.bWanted && (!bFits || Managed.AwayTime >= this->UnloadDelay)) {
+			// Over budget, or away long enough; nearer levels keep their memory.
+			this->Record(EStreamingEvent::REQUEST_UNLOAD, Managed.Region.Level, Current);
+			Managed.RequestUnload();
+			Managed.bWanted = false;
+		}
+
+		if (Managed.bWanted) {
+			Memory += Managed.Region.MemoryMB;
+			Managed.RequestVisible();
+		}
+	}
+
+	SET_FLOAT_STAT(STAT_StreamingDirectorMemory, Memory);
+	CSV_CUSTOM_STAT(PlaygroundStreaming, LoadedMB, Memory, ECsvCustomStatOp::Set);
+}
+
+TStatId UStreamingDirectorSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStreamingDirectorSubsystem, STATGROUP_Tickables);
+}
+
+void UStreamingDirectorSubsystem::LogTimeline() const {
+	const double Start = this->Timeline.Num() > 0 ? this->Timeline[0].Time : 0.0;
+
+	for (const FTimelineEntry& Entry : this->Timeline) {
+		UE_LOG(LogTemp, Log, TEXT("%9.3f %-16s %-12s %.1f"),
+			Entry.Time - Start,
+			*UEnum::GetValueAsString(Entry.Event),
+			*Entry.Level.ToString(),
+			Entry.Value);
+	}
+}
+
+static FAutoConsoleCommandWithWorld GDumpStreamingTimelineCommand(
+	TEXT("Playground.DumpStreamingTimeline"),
+	TEXT("Logs sublevel load requests, completions (with load time in ms) and hitches (frame time in ms)."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World) {
+		if (auto Subsystem = UWorld::GetSubsystem<UStreamingDirectorSubsystem>(World)) {
+			Subsystem->LogTimeline();
+		}
+	}));
@@ -0,0 +1,146 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "StreamingDirectorSubsystem.generated.h"
+
+class ULevelStreaming;
+class ALevelInstance;
+
+/**
+ * Level managed by UStreamingDirectorSubsystem. Bounds default to the level's streaming volumes for
+ * sublevels, and to a box of InstanceExtent around the actor for level instances.
+ */
+USTRUCT(BlueprintType)
+struct FStreamingRegion
+{
+	GENERATED_BODY()
+
+public:
+	/** Short package name of the sublevel or level instance's world, e.g. Village. **/
+	UPROPERTY(Config, EditAnywhere, Category = "Streaming")
+	FName Level;
+
+	/** Area the level covers, leave empty to use its streaming volumes. **/
+	UPROPERTY(Config, EditAnywhere, Category = "Streaming")
+	FBox Bounds = FBox(ForceInit);
+
+	/** Estimated memory of the loaded level, counted against the budget. **/
+	UPROPERTY(Config, EditAnywhere, Category = "Streaming")
+	float MemoryMB = 128.0f;
+};
+
+UENUM()
+enum class EStreamingEvent : uint8 {
+	REQUEST_LOAD,
+	LOADED,
+	SHOWN,
+	HIDDEN,
+	REQUEST_UNLOAD,
+	UNLOADED,
+	HITCH,
+};
+
+/**
+ * Loads levels (Village, SpiralTower) ahead of the player instead of waiting for streaming volumes or the
+ * World Partition grid. In World Partition maps such as Main they are placed as level instance actors,
+ * which are loaded and unloaded through ILevelInstanceInterface and picked up as their cells stream in;
+ * in other maps they are sublevels of the persistent level. The player's position is extrapolated along its velocity and facing over PredictionTime, and a level
+ * starts loading as soon as that path comes within LoadDistance of its bounds. It is made visible as
+ * soon as the load completes, so the time sliced add to world runs while the player is still far away
+ * rather than when they arrive. Levels unload after staying beyond UnloadDistance for UnloadDelay
+ * seconds. Loads never exceed MemoryBudgetMB; the nearest levels win.
+ *
+ * Every request, completion and hitch is recorded in a timeline, see Playground.DumpStreamingTimeline.
+ */
+UCLASS(Config=Game)
+class UStreamingDirectorSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	struct FManaged {
+		// Exactly one is set.
+		TWeakObjectPtr<ULevelStreaming> Streaming;
+		TWeakObjectPtr<ALevelInstance> Instance;
+		FStreamingRegion Region;
+		double RequestTime;
+		// Seconds the level has been beyond UnloadDistance while loaded.
+		float AwayTime;
+		bool bWanted;
+		bool bLoaded;
+		bool bVisible;
+
+		bool IsValid() const;
+		bool IsLoaded() const;
+		bool IsVisible() const;
+		bool ShouldBeLoaded() const;
+		bool IsPending() const;
+		void RequestLoad();
+		void RequestUnload();
+		void RequestVisible();
+	};
+
+	struct FTimelineEntry {
+		double Time;
+		EStreamingEvent Event;
+		FName Level;
+		float Value;
+	};
+
+	TArray<FManaged> Levels;
+	TArray<FTimelineEntry> Timeline;
+	FDelegateHandle LevelAddedHandle;
+
+public:
+	UPROPERTY(Config, EditAnywhere, Category = "Streaming")
+	TArray<FStreamingRegion> Regions;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Streaming")
+	float PredictionTime = 4.0f;
+
+	/** Half size of the area a level instance covers when its region has no bounds. **/
+	UPROPERTY(Config, EditAnywhere, Category = "Streaming")
+	float InstanceExtent = 5000.0f;
+
+	/** Distance ahead along the view direction added to the prediction, for players looking at a level. **/
+	UPROPERTY(Config, EditAnywhere, Category = "Streaming")
+	float LookAhead = 2000.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Streaming")
+	float LoadDistance = 3000.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Streaming")
+	float UnloadDistance = 6000.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Streaming")
+	float UnloadDelay = 10.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Streaming")
+	float MemoryBudgetMB = 512.0f;
+
+	/** Real frames longer than this, regardless of time dilation, are logged as hitches along with the levels streaming at the time. **/
+	UPROPERTY(Config, EditAnywhere, Category = "Streaming")
+	float HitchThresholdMs = 50.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Streaming")
+	int32 MaxTimelineEntries = 1024;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Logs the timeline of streaming requests, completions and hitches. **/
+	void LogTimeline() const;
+
+private:
+	void Record(EStreamingEvent Event, FName Level, float Value = 0.0f);
+	const FStreamingRegion* FindRegion(const FString& PackageName) const;
+	void AddInstances(ULevel* Level);
+	void OnLevelAdded(ULevel* Level, UWorld* InWorld);
+	bool Predict(TArray<FVector>& OutPath) const;
+	static float DistanceToPath(const FBox& Bounds, const TArray<FVector>& Path);
+};
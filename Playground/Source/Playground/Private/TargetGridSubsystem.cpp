@@ -0,0 +1,189 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TargetGridSubsystem.h"
+#include "Components/SceneComponent.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_STATS_GROUP(TEXT("TargetGrid"), STATGROUP_TargetGrid, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Query"), STAT_TargetGridQuery, STATGROUP_TargetGrid);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Cell Changes"), STAT_TargetGridCellChanges, STATGROUP_TargetGrid);
+
+void UTargetGridSubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+	Super::Initialize(Collection);
+	this->Grid.Reset(this->CellSize);
+}
+
+void UTargetGridSubsystem::Deinitialize() {
+	for (const FTarget& Target : this->Targets) {
+		if (Target.Actor.IsValid() && Target.Actor->GetRootComponent()) {
+			Target.Actor->GetRootComponent()->TransformUpdated.Remove(Target.Handle);
+		}
+	}
+
+	this->Targets.Reset();
+	this->Ids.Reset();
+	this->Grid.Reset(this->CellSize);
+	Super::Deinitialize();
+}
+
+void UTargetGridSubsystem::Register(AActor* Actor) {
+	if (Actor == nullptr || this->Ids.Contains(Actor)) {
+		return;
+	}
+
+	const int32 Id = this->Grid.Add(Actor->GetActorLocation());
+	if (!this->Targets.IsValidIndex(Id)) {
+		this->Targets.SetNum(Id + 1);
+	}
+
+	FTarget& Target = this->Targets[Id];
+	Target.Actor = Actor;
+	if (USceneComponent* Root = Actor->GetRootComponent()) {
+		Target.Handle = Root->TransformUpdated.AddUObject(this, &UTargetGridSubsystem::OnTransformUpdated, Id);
+	}
+
+	this->Ids.Add(Actor, Id);
+}
+
+void UTargetGridSubsystem::Unregister(AActor* Actor) {
+	int32 Id;
+	if (!this->Ids.RemoveAndCopyValue(Actor, Id)) {
+		return;
+	}
+
+	FTarget& Target = this->Targets[Id];
+	if (Actor && Actor->GetRootComponent()) {
+		Actor->GetRootComponent()->TransformUpdated.Remove(Target.Handle);
+	}
+
+	Target = FTarget();
+	this->Grid.Remove(Id);
+}
+
+void UTargetGridSubsystem::OnTransformUpdated(USceneComponent* Component, EUpdateTransformFlags Flags,
+	ETeleportType Teleport, int32 Id)
+{
+	if (this->Grid.Move(Id, Component->GetComponentLocation())) {
+		INC_DWORD_STAT(STAT_TargetGridCellChanges);
+	}
+}
+
+TArray<AActor*> UTargetGridSubsystem::Resolve(const TArray<int32>& Found, const AActor* Ignore) const {
+	TArray<AActor*> Out;
+	Out.Reserve(Found.Num());
+
+	for (int32 Id : Found) {
+		AActor* Actor = this->Targets[Id].Actor.Get();
+		if (Actor && Actor != Ignore) {
+			Out.Add(Actor);
+		}
+	}
+
+	return Out;
+}
+
+TArray<AActor*> UTargetGridSubsystem::GetTargetsInRadius(FVector Origin, float Radius, AActor* Ignore) const {
+	SCOPE_CYCLE_COUNTER(STAT_TargetGridQuery);
+	TArray<int32> Found;
+	this->Grid.QueryRadius(Origin, Radius, Found);
+	return this->Resolve(Found, Ignore);
+}
+
+TArray<AActor*> UTargetGridSubsystem::GetTargetsInCone(FVector Origin, FVector Direction, float HalfAngleDegrees,
+	float Range, AActor* Ignore) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_TargetGridQuery);
+	TArray<int32> Found;
+	this->Grid.QueryCone(Origin, Direction, HalfAngleDegrees, Range, Found);
+	return this->Resolve(Found, Ignore);
+}
+
+TArray<AActor*> UTargetGridSubsystem::GetNearestTargets(FVector Origin, int32 Count, float MaxRadius, AActor* Ignore) const {
+	SCOPE_CYCLE_COUNTER(STAT_TargetGridQuery);
+	TArray<int32> Found;
+	// One extra in case Ignore is among the nearest.
+	this->Grid.QueryNearest(Origin, Ignore ? Count + 1 : Count, MaxRadius, Found);
+
+	TArray<AActor*> Out = this->Resolve(Found, Ignore);
+	if (Out.Num() > Count) {
+		Out.SetNum(Count);
+	}
+	return Out;
+}
+
+/**
+ * Times radius, cone and nearest queries on FTargetHashGrid against a linear scan for growing
+ * populations of points scattered over a 20km square.
+ *
+ * Usage: Playground.BenchmarkTargetGrid [MaxPopulation] [Queries]
+ */
+static void RunTargetGridBenchmark(const TArray<FString>& Args) {
+	const int32 MaxPopulation = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 10000;
+	const int32 Queries = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 1000;
+	const float Radius = 1500.0f;
+
+	for (int32 Population = 100; Population <= MaxPopulation; Population *= 10) {
+		FRandomStream Random(Population);
+		FTargetHashGrid Grid(1000.0f);
+		TArray<FVector> Points;
+
+		for (int32 i = 0; i < Population; ++i) {
+			const FVector Point(Random.FRandRange(-10000.0f, 10000.0f), Random.FRandRange(-10000.0f, 10000.0f), 0.0f);
+			Points.Add(Point);
+			Grid.Add(Point);
+		}
+
+		TArray<FVector> Origins;
+		for (int32 i = 0; i < Queries; ++i) {
+			Origins.Add(Points[Random.RandHelper(Population)]);
+		}
+
+		TArray<int32> Found;
+		int32 LinearHits = 0, GridHits = 0;
+
+		double Start = FPlatformTime::Seconds();
+		for (const FVector& Origin : Origins) {
+			for (const FVector& Point : Points) {
+				LinearHits += FVector::DistSquared(Origin, Point) <= Radius * Radius;
+			}
+		}
+		const double LinearTime = FPlatformTime::Seconds() - Start;
+
+		Start = FPlatformTime::Seconds();
+		for (const FVector& Origin : Origins) {
+			Found.Reset();
+			Grid.QueryRadius(Origin, Radius, Found);
+			GridHits += Found.Num();
+		}
+		const double RadiusTime = FPlatformTime::Seconds() - Start;
+
+		Start = FPlatformTime::Seconds();
+		for (const FVector& Origin : Origins) {
+			Found.Reset();
+			Grid.QueryCone(Origin, FVector::ForwardVector, 30.0f, Radius, Found);
+		}
+		const double ConeTime = FPlatformTime::Seconds() - Start;
+
+		Start = FPlatformTime::Seconds();
+		for (const FVector& Origin : Origins) {
+			Found.Reset();
+			Grid.QueryNearest(Origin, 5, Radius, Found);
+		}
+		const double NearestTime = FPlatformTime::Seconds() - Start;
+
+		UE_LOG(LogTemp, Log, TEXT("BenchmarkTargetGrid: %d targets, linear %.2f us, radius %.2f us, cone %.2f us, nearest %.2f us per query%s"),
+			Population,
+			LinearTime * 1e6 / Queries,
+			RadiusTime * 1e6 / Queries,
+			ConeTime * 1e6 / Queries,
+			NearestTime * 1e6 / Queries,
+			LinearHits == GridHits ? TEXT("") : TEXT(", RESULTS DIFFER"));
+	}
+}
+
+static FAutoConsoleCommandWithArgs GBenchmarkTargetGridCommand(
+	TEXT("Playground.BenchmarkTargetGrid"),
+	TEXT("Times target grid queries against a linear scan as the population grows. Args: [MaxPopulation] [Queries]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&RunTargetGridBenchmark));
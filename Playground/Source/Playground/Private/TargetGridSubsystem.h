@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TargetHashGrid.h"
+#include "TargetGridSubsystem.generated.h"
+
+/**
+ * Keeps every targetable actor (anything with a UTargetableComponent, or registered by hand from a
+ * BPI_Targetable implementer) in a uniform spatial hash, so hostile checks and lock-on can ask for nearby
+ * targets without physics overlaps or actor iteration. Entries follow their actor's root component
+ * through TransformUpdated, so only actors that move pay for updates.
+ */
+UCLASS(Config=Game)
+class UTargetGridSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	struct FTarget {
+		TWeakObjectPtr<AActor> Actor;
+		FDelegateHandle Handle;
+	};
+
+	FTargetHashGrid Grid;
+	// Indexed by grid id.
+	TArray<FTarget> Targets;
+	TMap<TWeakObjectPtr<AActor>, int32> Ids;
+
+public:
+	/** Edge length of a grid cell. Around the typical query radius works best. **/
+	UPROPERTY(Config, EditAnywhere, Category = "Targeting")
+	float CellSize = 1000.0f;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	UFUNCTION(BlueprintCallable, Category = "Targeting")
+	void Register(AActor* Actor);
+
+	UFUNCTION(BlueprintCallable, Category = "Targeting")
+	void Unregister(AActor* Actor);
+
+	UFUNCTION(BlueprintCallable, Category = "Targeting", meta = (AdvancedDisplay = "Ignore"))
+	TArray<AActor*> GetTargetsInRadius(FVector Origin, float Radius, AActor* Ignore = nullptr) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Targeting", meta = (AdvancedDisplay = "Ignore"))
+	TArray<AActor*> GetTargetsInCone(FVector Origin, FVector Direction, float HalfAngleDegrees, float Range,
+		AActor* Ignore = nullptr) const;
+
+	/** Up to Count targets within MaxRadius of Origin, nearest first. **/
+	UFUNCTION(BlueprintCallable, Category = "Targeting", meta = (AdvancedDisplay = "Ignore"))
+	TArray<AActor*> GetNearestTargets(FVector Origin, int32 Count, float MaxRadius, AActor* Ignore = nullptr) const;
+
+	FORCEINLINE const FTargetHashGrid& GetGrid() const { return this->Grid; }
+	FORCEINLINE int32 Num() const { return this->Grid.Num(); }
+
+private:
+	void OnTransformUpdated(USceneComponent* Component, EUpdateTransformFlags Flags, ETeleportType Teleport, int32 Id);
+	TArray<AActor*> Resolve(const TArray<int32>& Found, const AActor* Ignore) const;
+};
@@ -0,0 +1,155 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TargetHashGrid.h"
+#include "Algo/Sort.h"
+
+FTargetHashGrid::FTargetHashGrid(float InCellSize) {
+	this->Reset(InCellSize);
+}
+
+void FTargetHashGrid::Reset(float InCellSize) {
+	this->CellSize = FMath::Max(1.0f, InCellSize);
+	this->InvCellSize = 1.0f / this->CellSize;
+	this->Items.Reset();
+	this->FreeIds.Reset();
+	this->Cells.Reset();
+}
+
+void FTargetHashGrid::Insert(int32 Id) {
+	FItem& Item = this->Items[Id];
+	TArray<int32>& Cell = this->Cells.FindOrAdd(Item.Cell);
+	Item.Slot = Cell.Add(Id);
+}
+
+void FTargetHashGrid::Unlink(int32 Id) {
+	FItem& Item = this->Items[Id];
+	TArray<int32>& Cell = this->Cells.FindChecked(Item.Cell);
+
+	Cell.RemoveAtSwap(Item.Slot, 1, false);
+	if (Cell.IsValidIndex(Item.Slot)) {
+		this->Items[Cell[Item.Slot]].Slot = Item.Slot;
+	}
+	if (Cell.Num() == 0) {
+		this->Cells.Remove(Item.Cell);
+	}
+
+	Item.Slot = INDEX_NONE;
+}
+
+int32 FTargetHashGrid::Add(const FVector& Location) {
+	const int32 Id = this->FreeIds.Num() > 0 ? this->FreeIds.Pop(false) : this->Items.AddUninitialized();
+	this->Items[Id] = { Location, this->CellOf(Location), INDEX_NONE };
+	this->Insert(Id);
+	return Id;
+}
+
+void FTargetHashGrid::Remove(int32 Id) {
+	if (this->IsValid(Id)) {
+		this->Unlink(Id);
+		this->FreeIds.Add(Id);
+	}
+}
+
+bool FTargetHashGrid::Move(int32 Id, const FVector& Location) {
+	if (!this->IsValid(Id)) {
+		return false;
+	}
+
+	FItem& Item = this->Items[Id];
+	const FIntPoint Cell = this->CellOf(Location);
+	Item.Location = Location;
+
+	if (Cell == Item.Cell) {
+		return false;
+	}
+
+	this->Unlink(Id);
+	Item.Cell = Cell;
+	this->Insert(Id);
+	return true;
+}
+
+// WORLD_MAX, which reaches across the whole world from anywhere in it. Larger extents would only
+// overflow the cell coordinates.
+constexpr float MAX_QUERY_EXTENT = 2097152.0f;
+
+template <typename Predicate>
+void FTargetHashGrid::ForEachInBox(const FVector& Origin, float Extent, Predicate&& Test) const {
+	Extent = FMath::Clamp(Extent, 0.0f, MAX_QUERY_EXTENT);
+	const FIntPoint Min = this->CellOf(Origin - FVector(Extent));
+	const FIntPoint Max = this->CellOf(Origin + FVector(Extent));
+
+	// Sparse worlds have fewer occupied cells than the box covers, walk those instead.
+	if (((int64) Max.X - Min.X + 1) * ((int64) Max.Y - Min.Y + 1) > this->Cells.Num()) {
+		for (const auto& Pair : this->Cells) {
+			if (Pair.Key.X >= Min.X && Pair.Key.X <= Max.X && Pair.Key.Y >= Min.Y && Pair.Key.Y <= Max.Y) {
+				for (int32 Id : Pair.Value) {
+					Test(Id, this->Items[Id].Location);
+				}
+			}
+		}
+		return;
+	}
+
+	for (int32 X = Min.X; X <= Max.X; ++X) {
+		for (int32 Y = Min.Y; Y <= Max.Y; ++Y) {
+			if (const TArray<int32>* Cell = this->Cells.Find(FIntPoint(X, Y))) {
+				for (int32 Id : *Cell) {
+					Test(Id, this->Items[Id].Location);
+				}
+			}
+		}
+	}
+}
+
+void FTargetHashGrid::QueryRadius(const FVector& Origin, float Radius, TArray<int32>& Out) const {
+	const float RadiusSquared = Radius * Radius;
+
+	this->ForEachInBox(Origin, Radius, [&](int32 Id, const FVector& Location) {
+		if (FVector::DistSquared(Origin, Location) <= RadiusSquared) {
+			Out.Add(Id);
+		}
+	});
+}
+
+void FTargetHashGrid::QueryCone(const FVector& Origin, const FVector& Direction, float HalfAngleDegrees, float Range,
+	TArray<int32>& Out) const
+{
+	const FVector Forward = Direction.GetSafeNormal();
+	const float CosHalfAngle = FMath::Cos(FMath::DegreesToRadians(FMath::Clamp(HalfAngleDegrees, 0.0f, 180.0f)));
+	const float RangeSquared = Range * Range;
+
+	this->ForEachInBox(Origin, Range, [&](int32 Id, const FVector& Location) {
+		const FVector Offset = Location - Origin;
+		const float DistSquared = Offset.SizeSquared();
+
+		if (DistSquared > RangeSquared) {
+			return;
+		}
+
+		// Dot >= Cos * |Offset|, squared with signs kept so no offset needs normalizing.
+		const float Dot = FVector::DotProduct(Offset, Forward);
+		if (Dot * FMath::Abs(Dot) >= CosHalfAngle * FMath::Abs(CosHalfAngle) * DistSquared) {
+			Out.Add(Id);
+		}
+	});
+}
+
+void FTargetHashGrid::QueryNearest(const FVector& Origin, int32 Count, float MaxRadius, TArray<int32>& Out) const {
+	if (Count <= 0) {
+		return;
+	}
+
+	const int32 First = Out.Num();
+	this->QueryRadius(Origin, MaxRadius, Out);
+
+	TArrayView<int32> Found(Out.GetData() + First, Out.Num() - First);
+	Algo::SortBy(Found, [this, &Origin](int32 Id) {
+		return FVector::DistSquared(Origin, this->Items[Id].Location);
+	});
+
+	if (Found.Num() > Count) {
+		Out.SetNum(First + Count, false);
+	}
+}
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Uniform 2D spatial hash of points, bucketed by X and Y. Ids are dense and reused after removal.
+ * Moving a point within its cell only updates its location; crossing a cell is a swap remove and an add.
+ */
+class FTargetHashGrid
+{
+public:
+	explicit FTargetHashGrid(float InCellSize = 1000.0f);
+
+	void Reset(float InCellSize);
+
+	int32 Add(const FVector& Location);
+	void Remove(int32 Id);
+	/** Updates a point's location. Returns true if it moved to another cell. **/
+	bool Move(int32 Id, const FVector& Location);
+
+	/** Appends every point within Radius of Origin. **/
+	void QueryRadius(const FVector& Origin, float Radius, TArray<int32>& Out) const;
+	/** Appends every point within Range of Origin whose direction is within the cone around Direction. **/
+	void QueryCone(const FVector& Origin, const FVector& Direction, float HalfAngleDegrees, float Range, TArray<int32>& Out) const;
+	/** Appends up to Count points within MaxRadius of Origin, nearest first. **/
+	void QueryNearest(const FVector& Origin, int32 Count, float MaxRadius, TArray<int32>& Out) const;
+
+	FORCEINLINE const FVector& GetLocation(int32 Id) const { return this->Items[Id].Location; }
+	FORCEINLINE bool IsValid(int32 Id) const { return this->Items.IsValidIndex(Id) && this->Items[Id].Slot != INDEX_NONE; }
+	FORCEINLINE int32 Num() const { return this->Items.Num() - this->FreeIds.Num(); }
+	FORCEINLINE int32 NumCells() const { return this->Cells.Num(); }
+
+private:
+	struct FItem {
+		FVector Location;
+		FIntPoint Cell;
+		// Index in the cell's array, INDEX_NONE when the id is free.
+		int32 Slot;
+	};
+
+	float CellSize;
+	float InvCellSize;
+	TArray<FItem> Items;
+	TArray<int32> FreeIds;
+	TMap<FIntPoint, TArray<int32>> Cells;
+
+	FORCEINLINE FIntPoint CellOf(const FVector& Location) const {
+		return FIntPoint(FMath::FloorToInt(Location.X * this->InvCellSize), FMath::FloorToInt(Location.Y * this->InvCellSize));
+	}
+
+	void Insert(int32 Id);
+	void Unlink(int32 Id);
+
+	template <typename Predicate>
+	void ForEachInBox(const FVector& Origin, float Extent, Predicate&& Test) const;
+};
@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TargetableComponent.h"
+#include "TargetGridSubsystem.h"
+#include "Engine/World.h"
+
+void UTargetableComponent::BeginPlay() {
+	Super::BeginPlay();
+
+	if (auto Grid = UWorld::GetSubsystem<UTargetGridSubsystem>(this->GetWorld())) {
+		Grid->Register(this->GetOwner());
+	}
+}
+
+void UTargetableComponent::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	if (auto Grid = UWorld::GetSubsystem<UTargetGridSubsystem>(this->GetWorld())) {
+		Grid->Unregister(this->GetOwner());
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
@@ -0,0 +1,20 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "TargetableComponent.generated.h"
+
+/**
+ * Registers its owner with UTargetGridSubsystem while in play.
+ */
+UCLASS(ClassGroup=(Playground), meta=(BlueprintSpawnableComponent))
+class UTargetableComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+};
@@ -0,0 +1,128 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "VerifyMovementModesCommandlet.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "PlaygroundCharacter.h"
+
+namespace VerifyMovementModes {
+
+	/*
+	 * Ends a frame the way the engine would: polled characters Step from their Tick, event driven ones
+	 * run the check scheduled by their transitions after actors tick. Returns the state the frame ends in.
+	 */
+	static EPlaygroundCharacterState EndFrame(APlaygroundCharacter* Character, bool bEventDriven) {
+		auto Machine = Character->GetMachine();
+		if (bEventDriven) {
+			Character->RunMovementCheck();
+		} else {
+			Machine->Step(1.0f / 60.0f);
+		}
+		return (EPlaygroundCharacterState) Machine->CurrentState->ID;
+	}
+
+	static TArray<EPlaygroundCharacterState> Run(APlaygroundCharacter* Character, bool bEventDriven) {
+		TArray<EPlaygroundCharacterState> States;
+		auto Machine = Character->GetMachine();
+		auto Movement = Character->GetCharacterMovement();
+
+		Character->SetEventDrivenMovement(bEventDriven);
+		Movement->SetMovementMode(MOVE_Walking);
+		Character->ForceState(EPlaygroundCharacterState::IDLE);
+		EndFrame(Character, bEventDriven);
+
+		// Falling and landing from Idle.
+		Movement->SetMovementMode(MOVE_Falling);
+		States.Add(EndFrame(Character, bEventDriven));
+		Movement->SetMovementMode(MOVE_Walking);
+		States.Add(EndFrame(Character, bEventDriven));
+
+		// Walking off a ledge, letting go mid-air, then landing.
+		Machine->InputAxis = FVector2D(0.0f, 1.0f);
+		Machine->AttemptMove();
+		States.Add(EndFrame(Character, bEventDriven));
+		Movement->SetMovementMode(MOVE_Falling);
+		States.Add(EndFrame(Character, bEventDriven));
+		Machine->StopMove();
+		States.Add(EndFrame(Character, bEventDriven));
+		Movement->SetMovementMode(MOVE_Walking);
+		States.Add(EndFrame(Character, bEventDriven));
+
+		// A jump that never reaches falling: the world has no ticking movement, so Jump() never applies.
+		Machine->AttemptJump();
+		States.Add(EndFrame(Character, bEventDriven));
+		Character->StopJumping();
+		States.Add(EndFrame(Character, bEventDriven));
+
+		return States;
+	}
+}
+
+int32 UVerifyMovementModesCommandlet::Verify(UWorld* World) {
+	using namespace VerifyMovementModes;
+
+	FActorSpawnParameters Params;
+	Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	APlaygroundCharacter* Character = World->SpawnActor<APlaygroundCharacter>(
+		APlaygroundCharacter::StaticClass(), FTransform::Identity, Params);
+
+	if (Character == nullptr) {
+		UE_LOG(LogTemp, Error, TEXT("VerifyMovementModes: Could not spawn a PlaygroundCharacter."));
+		return 1;
+	}
+
+	auto Polled = Run(Character, false);
+	auto Evented = Run(Character, true);
+	Character->Destroy();
+
+	int32 Mismatches = 0;
+	for (int32 i = 0; i < Polled.Num(); ++i) {
+		if (Polled[i] != Evented[i]) {
+			++Mismatches;
+			UE_LOG(LogTemp, Error, TEXT("VerifyMovementModes: Frame %d polled %s, event driven %s."),
+				i,
+				*UEnum::GetValueAsString(Polled[i]),
+				*UEnum::GetValueAsString(Evented[i]));
+		}
+	}
+
+	if (Mismatches == 0) {
+		UE_LOG(LogTemp, Display, TEXT("VerifyMovementModes: %d frames match."), Polled.Num());
+	}
+
+	return Mismatches;
+}
+
+UVerifyMovementModesCommandlet::UVerifyMovementModesCommandlet() {
+	this->IsClient = false;
+	this->IsEditor = false;
+	this->IsServer = false;
+	this->LogToConsole = true;
+}
+
+int32 UVerifyMovementModesCommandlet::Main(const FString& Params) {
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	FWorldContext& Context = GEngine->CreateNewWorldContext(EWorldType::Game);
+	Context.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	const int32 Mismatches = Verify(World);
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	return Mismatches > 0 ? 1 : 0;
+}
+
+static FAutoConsoleCommandWithWorld GVerifyMovementModesCommand(
+	TEXT("Playground.VerifyMovementModes"),
+	TEXT("Checks polled and event driven Airborne transitions of the character state machine agree."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World) {
+		if (World) {
+			UVerifyMovementModesCommandlet::Verify(World);
+		}
+	}));
@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "VerifyMovementModesCommandlet.generated.h"
+
+/**
+ * Checks that event driven characters end every frame in the same state as polled ones. Runs scripted
+ * frames of movement mode changes and input, including a jump that never leaves the ground and walking
+ * off a ledge, through a polled and an event driven character. Returns non-zero on any mismatch.
+ *
+ * UnrealEditor-Cmd Playground.uproject -run=VerifyMovementModes -nullrhi -unattended
+ *
+ * Also available in game as Playground.VerifyMovementModes.
+ */
+UCLASS()
+class UVerifyMovementModesCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UVerifyMovementModesCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+	/** Runs the scripted frames in World. Returns the number of frames whose states differ. **/
+	static int32 Verify(UWorld* World);
+};
@@ -0,0 +1,153 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WaterWaveSubsystem.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "Components/StaticMeshComponent.h"
+#include "Materials/MaterialInterface.h"
+#include "Math/VectorRegister.h"
+
+DECLARE_STATS_GROUP(TEXT("WaterWaves"), STATGROUP_WaterWaves, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Sample Heights"), STAT_WaterSampleHeights, STATGROUP_WaterWaves);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Evaluated Points"), STAT_WaterEvaluatedPoints, STATGROUP_WaterWaves);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Cached Points"), STAT_WaterCachedPoints, STATGROUP_WaterWaves);
+
+UWaterWaveSubsystem::UWaterWaveSubsystem() {
+	FWaterWave X, Y;
+	Y.Direction = FVector2D(0.0f, 1.0f);
+	Y.Phase = HALF_PI;
+	this->Waves = { X, Y };
+}
+
+void UWaterWaveSubsystem::SetWaterPlane(AStaticMeshActor* Plane) {
+	if (Plane == nullptr) {
+		return;
+	}
+
+	this->BaseHeight = Plane->GetActorLocation().Z;
+
+	UStaticMeshComponent* Mesh = Plane->GetStaticMeshComponent();
+	UMaterialInterface* Material = Mesh ? Mesh->GetMaterial(0) : nullptr;
+	if (Material == nullptr) {
+		return;
+	}
+
+	float Amplitude, TimeScale;
+	const bool bAmplitude = Material->GetScalarParameterValue(FHashedMaterialParameterInfo(TEXT("Amplitude")), Amplitude);
+	const bool bTimeScale = Material->GetScalarParameterValue(FHashedMaterialParameterInfo(TEXT("TimeScale")), TimeScale);
+
+	for (FWaterWave& Wave : this->Waves) {
+		if (bAmplitude) {
+			Wave.Amplitude = Amplitude;
+		}
+		if (bTimeScale) {
+			Wave.Speed = TimeScale;
+		}
+	}
+
+	this->Cache.Reset();
+}
+
+void UWaterWaveSubsystem::Evaluate(const float* X, const float* Y, int32 Count, float Time, float* OutHeights) const {
+	const int32 Aligned = Count & ~3;
+	const VectorRegister4Float Base = VectorSetFloat1(this->BaseHeight);
+
+	for (int32 i = 0; i < Aligned; i += 4) {
+		const VectorRegister4Float PX = VectorLoad(X + i);
+		const VectorRegister4Float PY = VectorLoad(Y + i);
+		VectorRegister4Float Sum = Base;
+
+		for (const FWaterWave& Wave : this->Waves) {
+			// Fold frequency into the direction so each wave is two multiply adds and a sine.
+			const VectorRegister4Float DX = VectorSetFloat1(Wave.Direction.X * Wave.Frequency);
+			const VectorRegister4Float DY = VectorSetFloat1(Wave.Direction.Y * Wave.Frequency);
+			const VectorRegister4Float Offset = VectorSetFloat1(Wave.Speed * Time + Wave.Phase);
+			const VectorRegister4Float Angle = VectorMultiplyAdd(PX, DX, VectorMultiplyAdd(PY, DY, Offset));
+
+			Sum = VectorMultiplyAdd(VectorSin(Angle), VectorSetFloat1(Wave.Amplitude), Sum);
+		}
+
+		VectorStore(Sum, OutHeights + i);
+	}
+
+	for (int32 i = Aligned; i < Count; ++i) {
+		float Sum = this->BaseHeight;
+		for (const FWaterWave& Wave : this->Waves) {
+			const float Angle = Wave.Frequency * (Wave.Direction.X * X[i] + Wave.Direction.Y * Y[i]) + Wave.Speed * Time + Wave.Phase;
+			Sum += Wave.Amplitude * FMath::Sin(Angle);
+		}
+		OutHeights[i] = Sum;
+	}
+}
+
+void UWaterWaveSubsystem::SampleHeights(TConstArrayView<FVector> Points, TArrayView<float> OutHeights) {
+	SCOPE_CYCLE_COUNTER(STAT_WaterSampleHeights);
+	check(Points.Num() == OutHeights.Num());
+
+	const UWorld* World = this->GetWorld();
+	const float Time = World ? World->GetTimeSeconds() : 0.0f;
+	const bool bCache = this->CacheResolution > 0.0f;
+	const float InvResolution = bCache ? 1.0f / this->CacheResolution : 0.0f;
+
+	if (this->CacheFrame != GFrameCounter) {
+		this->CacheFrame = GFrameCounter;
+		this->Cache.Reset();
+	}
+
+	this->MissX.Reset();
+	this->MissY.Reset();
+	this->MissIndices.Reset();
+
+	auto CellOf = [InvResolution](const FVector& Point) {
+		return FIntPoint(FMath::RoundToInt(Point.X * InvResolution), FMath::RoundToInt(Point.Y * InvResolution));
+	};
+
+	for (int32 i = 0; i < Points.Num(); ++i) {
+		if (bCache) {
+			const FIntPoint Cell = CellOf(Points[i]);
+			if (const float* Height = this->Cache.Find(Cell)) {
+				OutHeights[i] = *Height;
+				continue;
+			}
+
+			// Evaluated at the cell centre, so every point snapped to the cell gets the same height.
+			this->MissX.Add(Cell.X * this->CacheResolution);
+			this->MissY.Add(Cell.Y * this->CacheResolution);
+		} else {
+			this->MissX.Add(Points[i].X);
+			this->MissY.Add(Points[i].Y);
+		}
+		this->MissIndices.Add(i);
+	}
+
+	const int32 Misses = this->MissIndices.Num();
+	this->MissHeights.SetNumUninitialized(Misses, false);
+	this->Evaluate(this->MissX.GetData(), this->MissY.GetData(), Misses, Time, this->MissHeights.GetData());
+
+	for (int32 i = 0; i < Misses; ++i) {
+		const int32 Index = this->MissIndices[i];
+		OutHeights[Index] = this->MissHeights[i];
+		if (bCache) {
+			this->Cache.Add(CellOf(Points[Index]), this->MissHeights[i]);
+		}
+	}
+
+	this->CacheHits += Points.Num() - Misses;
+	this->CacheMisses += Misses;
+	INC_DWORD_STAT_BY(STAT_WaterEvaluatedPoints, Misses);
+	INC_DWORD_STAT_BY(STAT_WaterCachedPoints, Points.Num() - Misses);
+}
+
+float UWaterWaveSubsystem::GetWaterHeight(FVector Location) {
+	float Height;
+	this->SampleHeights(MakeArrayView(&Location, 1), MakeArrayView(&Height, 1));
+	return Height;
+}
+
+TArray<float> UWaterWaveSubsystem::GetWaterHeights(const TArray<FVector>& Locations) {
+	TArray<float> Heights;
+	Heights.SetNumUninitialized(Locations.Num());
+	this->SampleHeights(Locations, Heights);
+	return Heights;
+}
@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WaterWaveSubsystem.generated.h"
+
+class AStaticMeshActor;
+
+/**
+ * One sine wave of the water surface: Amplitude * sin(Frequency * dot(Direction, XY) + Speed * Time + Phase).
+ */
+USTRUCT(BlueprintType)
+struct FWaterWave
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Water")
+	float Amplitude = 10.0f;
+
+	/**
+	 * Radians per unit along Direction. M_WaterPlane divides world XY by a constant before
+	 * MF_WaterAmplitude takes its sine, and that constant isn't a material parameter, so this is kept by
+	 * hand as one over it: 0.01 for the divisor of 100. Change both together.
+	 **/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Water")
+	float Frequency = 0.01f;
+
+	/** Radians per second, TimeScale in the water material. **/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Water")
+	float Speed = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Water")
+	FVector2D Direction = FVector2D(1.0f, 0.0f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Water")
+	float Phase = 0.0f;
+};
+
+/**
+ * CPU copy of the water surface that MF_WaterAmplitude displaces on the GPU, so buoyant props and water
+ * entities can query it. The default waves are the material's sin(X) + cos(Y) sum; SetWaterPlane reads
+ * Amplitude and TimeScale from the plane's material so both stay in sync, see FWaterWave::Frequency for
+ * the one value that isn't exposed.
+ *
+ * Heights are evaluated four points at a time with SIMD and cached per frame on a grid of
+ * CacheResolution, so systems sampling the same spots share one evaluation. Cached heights are those of
+ * the cell centre, so they don't depend on which point sampled the cell first.
+ */
+UCLASS(Config=Game)
+class UWaterWaveSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	TMap<FIntPoint, float> Cache;
+	uint64 CacheFrame = 0;
+
+	int32 CacheHits = 0;
+	int32 CacheMisses = 0;
+
+	// Scratch buffers for the misses of a batch.
+	TArray<float> MissX;
+	TArray<float> MissY;
+	TArray<float> MissHeights;
+	TArray<int32> MissIndices;
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Water")
+	TArray<FWaterWave> Waves;
+
+	/** Height of the undisplaced water plane. **/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Water")
+	float BaseHeight = 0.0f;
+
+	/** Size of the grid points are snapped to for the per frame cache, 0 disables it. **/
+	UPROPERTY(Config, EditAnywhere, Category = "Water")
+	float CacheResolution = 10.0f;
+
+	UWaterWaveSubsystem();
+
+	/** Takes the base height from a water plane and Amplitude/TimeScale from its material. **/
+	UFUNCTION(BlueprintCallable, Category = "Water")
+	void SetWaterPlane(AStaticMeshActor* Plane);
+
+	UFUNCTION(BlueprintCallable, Category = "Water")
+	float GetWaterHeight(FVector Location);
+
+	UFUNCTION(BlueprintCallable, Category = "Water")
+	TArray<float> GetWaterHeights(const TArray<FVector>& Locations);
+
+	/** Water heights under Points at the current world time. **/
+	void SampleHeights(TConstArrayView<FVector> Points, TArrayView<float> OutHeights);
+
+	/** Uncached SIMD evaluation of the wave sum over structure of arrays input. **/
+	void Evaluate(const float* X, const float* Y, int32 Count, float Time, float* OutHeights) const;
+
+	FORCEINLINE int32 GetCacheHits() const { return this->CacheHits; }
+	FORCEINLINE int32 GetCacheMisses() const { return this->CacheMisses; }
+};
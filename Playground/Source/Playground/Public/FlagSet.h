@@ -3,15 +3,129 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "UObject/NoExportTypes.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
 #include "FlagSet.generated.h"
 
 /**
- * 
+ * Fixed-width set of up to 64 flags, indexed by the underlying value of an enum. Membership,
+ * union, difference and clearing are single bitwise operations instead of hashed lookups.
+ */
+USTRUCT(BlueprintType)
+struct PLAYGROUND_API FFlagSet
+{
+	GENERATED_BODY()
+
+public:
+	static constexpr int32 CAPACITY = 64;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FlagSet")
+	int64 Bits = 0;
+
+	FFlagSet() {}
+	explicit FFlagSet(uint64 InBits): Bits((int64) InBits) {}
+
+	FORCEINLINE static uint64 Mask(uint8 Index) {
+		check(Index < CAPACITY);
+		return uint64(1) << Index;
+	}
+
+	FORCEINLINE bool Contains(uint8 Index) const { return ((uint64) this->Bits & Mask(Index)) != 0; }
+	FORCEINLINE void Add(uint8 Index) { this->Bits = (int64) ((uint64) this->Bits | Mask(Index)); }
+	FORCEINLINE void Remove(uint8 Index) { this->Bits = (int64) ((uint64) this->Bits & ~Mask(Index)); }
+	FORCEINLINE void Reset() { this->Bits = 0; }
+	FORCEINLINE bool IsEmpty() const { return this->Bits == 0; }
+	FORCEINLINE int32 Num() const { return FMath::CountBits((uint64) this->Bits); }
+
+	FORCEINLINE FFlagSet Union(const FFlagSet& Other) const { return FFlagSet((uint64) this->Bits | (uint64) Other.Bits); }
+	FORCEINLINE FFlagSet Intersect(const FFlagSet& Other) const { return FFlagSet((uint64) this->Bits & (uint64) Other.Bits); }
+	FORCEINLINE FFlagSet Difference(const FFlagSet& Other) const { return FFlagSet((uint64) this->Bits & ~(uint64) Other.Bits); }
+	FORCEINLINE bool TestAny(const FFlagSet& Other) const { return ((uint64) this->Bits & (uint64) Other.Bits) != 0; }
+
+	FORCEINLINE bool operator==(const FFlagSet& Other) const { return this->Bits == Other.Bits; }
+	FORCEINLINE bool operator!=(const FFlagSet& Other) const { return this->Bits != Other.Bits; }
+
+	/* Calls Func with the index of every set flag, lowest first. */
+	template <typename FuncType>
+	FORCEINLINE void ForEach(FuncType&& Func) const {
+		uint64 Remaining = (uint64) this->Bits;
+		while (Remaining != 0) {
+			const uint8 Index = (uint8) FMath::CountTrailingZeros64(Remaining);
+			Remaining &= Remaining - 1;
+			Func(Index);
+		}
+	}
+};
+
+/**
+ * Typed view over FFlagSet for a specific enum, so C++ callers don't need to cast.
+ */
+template <typename TEnum>
+struct TFlagSet
+{
+	static_assert(TIsEnum<TEnum>::Value, "TFlagSet must be indexed by an enum.");
+
+	FFlagSet Flags;
+
+	TFlagSet() {}
+	TFlagSet(const FFlagSet& InFlags): Flags(InFlags) {}
+
+	FORCEINLINE bool Contains(TEnum Value) const { return this->Flags.Contains((uint8) Value); }
+	FORCEINLINE void Add(TEnum Value) { this->Flags.Add((uint8) Value); }
+	FORCEINLINE void Remove(TEnum Value) { this->Flags.Remove((uint8) Value); }
+	FORCEINLINE void Reset() { this->Flags.Reset(); }
+	FORCEINLINE bool IsEmpty() const { return this->Flags.IsEmpty(); }
+	FORCEINLINE int32 Num() const { return this->Flags.Num(); }
+
+	FORCEINLINE TFlagSet Union(const TFlagSet& Other) const { return this->Flags.Union(Other.Flags); }
+	FORCEINLINE TFlagSet Intersect(const TFlagSet& Other) const { return this->Flags.Intersect(Other.Flags); }
+	FORCEINLINE TFlagSet Difference(const TFlagSet& Other) const { return this->Flags.Difference(Other.Flags); }
+	FORCEINLINE bool TestAny(const TFlagSet& Other) const { return this->Flags.TestAny(Other.Flags); }
+
+	FORCEINLINE bool operator==(const TFlagSet& Other) const { return this->Flags == Other.Flags; }
+	FORCEINLINE bool operator!=(const TFlagSet& Other) const { return this->Flags != Other.Flags; }
+
+	template <typename FuncType>
+	FORCEINLINE void ForEach(FuncType&& Func) const {
+		this->Flags.ForEach([&Func](uint8 Index) { Func((TEnum) Index); });
+	}
+};
+
+/**
+ * Blueprint accessors for FFlagSet. Enum values are passed as their byte value.
  */
 UCLASS()
-class PLAYGROUND_API UFlagSet : public UObject
+class PLAYGROUND_API UFlagSet : public UBlueprintFunctionLibrary
 {
 	GENERATED_BODY()
-	
+
+public:
+	UFUNCTION(BlueprintPure, Category = "FlagSet")
+	static bool Contains(const FFlagSet& Set, uint8 Flag) { return Flag < FFlagSet::CAPACITY && Set.Contains(Flag); }
+
+	UFUNCTION(BlueprintPure, Category = "FlagSet")
+	static FFlagSet Add(const FFlagSet& Set, uint8 Flag);
+
+	UFUNCTION(BlueprintPure, Category = "FlagSet")
+	static FFlagSet Remove(const FFlagSet& Set, uint8 Flag);
+
+	UFUNCTION(BlueprintPure, Category = "FlagSet")
+	static bool IsEmpty(const FFlagSet& Set) { return Set.IsEmpty(); }
+
+	UFUNCTION(BlueprintPure, Category = "FlagSet")
+	static int32 Num(const FFlagSet& Set) { return Set.Num(); }
+
+	UFUNCTION(BlueprintPure, Category = "FlagSet")
+	static FFlagSet Union(const FFlagSet& A, const FFlagSet& B) { return A.Union(B); }
+
+	UFUNCTION(BlueprintPure, Category = "FlagSet")
+	static FFlagSet Intersect(const FFlagSet& A, const FFlagSet& B) { return A.Intersect(B); }
+
+	UFUNCTION(BlueprintPure, Category = "FlagSet")
+	static FFlagSet Difference(const FFlagSet& A, const FFlagSet& B) { return A.Difference(B); }
+
+	UFUNCTION(BlueprintPure, Category = "FlagSet")
+	static bool TestAny(const FFlagSet& A, const FFlagSet& B) { return A.TestAny(B); }
+
+	UFUNCTION(BlueprintPure, Category = "FlagSet")
+	static TArray<uint8> ToArray(const FFlagSet& Set);
 };